@@ -0,0 +1,116 @@
+#pragma once
+#ifdef PROFILE_ALLOCATIONS
+#include "AllocationProfiler.h"
+#include <cstddef>
+#include <new>
+
+// Replaces the global allocation functions of a PROFILE_ALLOCATIONS build.
+// Include it from the file with main only, a program must define them once.
+#ifdef _WIN32
+#define ALLOCATION_CALLER _ReturnAddress()
+#else
+#define ALLOCATION_CALLER __builtin_return_address(0)
+#endif
+
+constexpr size_t DefaultNewAlignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+void* operator new(size_t size)
+{
+	return AllocationProfiler::Allocate(size, DefaultNewAlignment, ALLOCATION_CALLER, false);
+}
+
+void* operator new[](size_t size)
+{
+	return AllocationProfiler::Allocate(size, DefaultNewAlignment, ALLOCATION_CALLER, false);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return AllocationProfiler::Allocate(size, DefaultNewAlignment, ALLOCATION_CALLER, true);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return AllocationProfiler::Allocate(size, DefaultNewAlignment, ALLOCATION_CALLER, true);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	return AllocationProfiler::Allocate(size, static_cast<size_t>(alignment), ALLOCATION_CALLER, false);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	return AllocationProfiler::Allocate(size, static_cast<size_t>(alignment), ALLOCATION_CALLER, false);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return AllocationProfiler::Allocate(size, static_cast<size_t>(alignment), ALLOCATION_CALLER, true);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return AllocationProfiler::Allocate(size, static_cast<size_t>(alignment), ALLOCATION_CALLER, true);
+}
+
+void operator delete(void* data) noexcept
+{
+	AllocationProfiler::Free(data);
+}
+
+void operator delete[](void* data) noexcept
+{
+	AllocationProfiler::Free(data);
+}
+
+void operator delete(void* data, size_t) noexcept
+{
+	AllocationProfiler::Free(data);
+}
+
+void operator delete[](void* data, size_t) noexcept
+{
+	AllocationProfiler::Free(data);
+}
+
+void operator delete(void* data, const std::nothrow_t&) noexcept
+{
+	AllocationProfiler::Free(data);
+}
+
+void operator delete[](void* data, const std::nothrow_t&) noexcept
+{
+	AllocationProfiler::Free(data);
+}
+
+void operator delete(void* data, std::align_val_t) noexcept
+{
+	AllocationProfiler::Free(data);
+}
+
+void operator delete[](void* data, std::align_val_t) noexcept
+{
+	AllocationProfiler::Free(data);
+}
+
+void operator delete(void* data, size_t, std::align_val_t) noexcept
+{
+	AllocationProfiler::Free(data);
+}
+
+void operator delete[](void* data, size_t, std::align_val_t) noexcept
+{
+	AllocationProfiler::Free(data);
+}
+
+void operator delete(void* data, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	AllocationProfiler::Free(data);
+}
+
+void operator delete[](void* data, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	AllocationProfiler::Free(data);
+}
+#endif
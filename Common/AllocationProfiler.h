@@ -0,0 +1,336 @@
+#pragma once
+#ifdef PROFILE_ALLOCATIONS
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <dbghelp.h>
+#include <intrin.h>
+#pragma comment(lib, "dbghelp.lib")
+#else
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#endif
+
+// Counts heap traffic of a build with PROFILE_ALLOCATIONS defined. The global operator new and
+// delete of AllocationHooks.h route every allocation through here. Allocations are charged to the
+// phase of the innermost ScopedTimer and to their call site, the few return addresses above
+// operator new. Each block carries a header with its size and phase, so live bytes are known
+// per phase. Without PROFILE_ALLOCATIONS nothing of this is compiled.
+class AllocationProfiler
+{
+public:
+	static constexpr int MaxPhases = 64;
+	static constexpr int MaxSites = 4096;
+	static constexpr int SiteDepth = 4;
+	static constexpr int TopSites = 10;
+
+	// Makes the phase current and returns the previous one for LeavePhase
+	static int EnterPhase(std::string_view name)
+	{
+		std::lock_guard lock(Mutex());
+		int phase = 0;
+
+		while (phase < s_phaseCount && s_phases[phase].name != name)
+		{
+			phase++;
+		}
+
+		if (phase == s_phaseCount)
+		{
+			if (s_phaseCount == MaxPhases)
+			{
+				return s_current.load();
+			}
+
+			s_phases[s_phaseCount++].name = name;
+		}
+
+		return s_current.exchange(phase);
+	}
+
+	static void LeavePhase(int previous)
+	{
+		s_current.store(previous);
+	}
+
+	static void* Allocate(size_t size, size_t alignment, void* caller, bool nothrow)
+	{
+		alignment = std::max(alignment, HeaderSize);
+		char* raw = static_cast<char*>(std::malloc(size + alignment + HeaderSize));
+
+		if (raw == nullptr)
+		{
+			if (nothrow)
+			{
+				return nullptr;
+			}
+
+			throw std::bad_alloc();
+		}
+
+		uintptr_t start = reinterpret_cast<uintptr_t>(raw) + HeaderSize;
+		char* data = reinterpret_cast<char*>((start + alignment - 1) & ~(uintptr_t{ alignment } - 1));
+		Header* header = reinterpret_cast<Header*>(data) - 1;
+
+		header->size = size;
+		header->phase = s_current.load();
+		header->offset = static_cast<uint32_t>(data - raw);
+
+		Site site{};
+		CaptureSite(site, caller);
+
+		std::lock_guard lock(Mutex());
+		Phase& phase = s_phases[header->phase];
+
+		phase.allocations++;
+		phase.bytes += size;
+		phase.live += size;
+		phase.peakLive = std::max(phase.peakLive, phase.live);
+		AddToSite(site, size);
+
+		return data;
+	}
+
+	static void Free(void* data)
+	{
+		if (data == nullptr)
+		{
+			return;
+		}
+
+		Header* header = static_cast<Header*>(data) - 1;
+		char* raw = static_cast<char*>(data) - header->offset;
+
+		{
+			std::lock_guard lock(Mutex());
+			Phase& phase = s_phases[header->phase];
+			phase.frees++;
+			phase.live -= header->size;
+		}
+
+		std::free(raw);
+	}
+
+	// "phases": {"name": {...}, ...}, "top_sites": [{"frames": [...], ...}, ...]
+	static void Write(std::ostream& stream)
+	{
+		// The snapshot goes to static buffers, so taking it allocates nothing that would show up in it.
+		// Streaming may allocate again, after the snapshot.
+		static Phase phases[MaxPhases];
+		static Site sites[MaxSites];
+		int phaseCount = 0;
+
+		{
+			std::lock_guard lock(Mutex());
+			phaseCount = s_phaseCount;
+			std::copy_n(s_phases, MaxPhases, phases);
+			std::copy_n(s_sites, MaxSites, sites);
+		}
+
+		stream << "\"phases\": {";
+
+		for (int i = 0; i < phaseCount; i++)
+		{
+			const Phase& phase = phases[i];
+			stream << (i == 0 ? "" : ", ") << '"' << phase.name << "\": {\"allocations\": " << phase.allocations
+				   << ", \"frees\": " << phase.frees << ", \"bytes\": " << phase.bytes
+				   << ", \"live_bytes\": " << phase.live << ", \"peak_live_bytes\": " << phase.peakLive << '}';
+		}
+
+		// Both run in place
+		Site* used = std::partition(sites, sites + MaxSites, [](const Site& site) { return site.allocations != 0; });
+		Site* top = sites + std::min<ptrdiff_t>(used - sites, TopSites);
+		std::partial_sort(sites, top, used, [](const Site& left, const Site& right) { return left.bytes > right.bytes; });
+
+		stream << "}, \"top_sites\": [";
+
+		for (ptrdiff_t i = 0; i < top - sites; i++)
+		{
+			stream << (i == 0 ? "" : ", ") << "{\"frames\": [";
+
+			for (int f = 0; f < SiteDepth && sites[i].frames[f] != nullptr; f++)
+			{
+				stream << (f == 0 ? "" : ", ") << '"' << Escape(Describe(sites[i].frames[f])) << '"';
+			}
+
+			stream << "], \"allocations\": " << sites[i].allocations << ", \"bytes\": " << sites[i].bytes << '}';
+		}
+
+		stream << ']';
+	}
+
+private:
+	struct alignas(16) Header
+	{
+		uint64_t size;
+		int32_t phase;
+		uint32_t offset;
+	};
+
+	static constexpr size_t HeaderSize = sizeof(Header);
+
+	struct Phase
+	{
+		std::string_view name;
+		uint64_t allocations = 0;
+		uint64_t frees = 0;
+		uint64_t bytes = 0;
+		int64_t live = 0;
+		int64_t peakLive = 0;
+	};
+
+	struct Site
+	{
+		void* frames[SiteDepth]{};
+		uint64_t allocations = 0;
+		uint64_t bytes = 0;
+	};
+
+	// A function-local mutex is ready even for allocations made before main
+	static std::mutex& Mutex()
+	{
+		static std::mutex mutex;
+		return mutex;
+	}
+
+	// Frames from the caller of operator new upwards, found by its return address
+	static void CaptureSite(Site& site, void* caller)
+	{
+		void* frames[SiteDepth + 8];
+#ifdef _WIN32
+		int count = CaptureStackBackTrace(0, SiteDepth + 8, frames, nullptr);
+#else
+		int count = backtrace(frames, SiteDepth + 8);
+#endif
+		int first = 0;
+
+		while (first < count && frames[first] != caller)
+		{
+			first++;
+		}
+
+		if (first == count)
+		{
+			site.frames[0] = caller;
+			return;
+		}
+
+		for (int f = 0; f < SiteDepth && first + f < count; f++)
+		{
+			site.frames[f] = frames[first + f];
+		}
+	}
+
+	// Open addressing over the frames, sites beyond MaxSites are not counted
+	static void AddToSite(const Site& site, size_t size)
+	{
+		uint64_t hash = 0;
+
+		for (void* frame : site.frames)
+		{
+			hash = (hash ^ reinterpret_cast<uintptr_t>(frame)) * 0x9E3779B97F4A7C15;
+		}
+
+		for (int probe = 0; probe < MaxSites; probe++)
+		{
+			Site& slot = s_sites[(hash + probe) % MaxSites];
+
+			if (slot.allocations == 0)
+			{
+				std::copy_n(site.frames, SiteDepth, slot.frames);
+			}
+
+			if (std::equal(site.frames, site.frames + SiteDepth, slot.frames))
+			{
+				slot.allocations++;
+				slot.bytes += size;
+				return;
+			}
+		}
+	}
+
+	// Function name and offset where the symbols are known, module and offset otherwise
+	static std::string Describe(void* address)
+	{
+#ifdef _WIN32
+		static bool initialized = SymInitialize(GetCurrentProcess(), nullptr, TRUE);
+		char buffer[sizeof(SYMBOL_INFO) + 256]{};
+		SYMBOL_INFO* symbol = reinterpret_cast<SYMBOL_INFO*>(buffer);
+		symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+		symbol->MaxNameLen = 255;
+		DWORD64 displacement = 0;
+
+		if (initialized && SymFromAddr(GetCurrentProcess(), reinterpret_cast<DWORD64>(address), &displacement, symbol))
+		{
+			return std::string(symbol->Name) + "+" + std::to_string(displacement);
+		}
+
+		return std::to_string(reinterpret_cast<uintptr_t>(address));
+#else
+		Dl_info info{};
+
+		if (dladdr(address, &info) == 0)
+		{
+			return std::to_string(reinterpret_cast<uintptr_t>(address));
+		}
+
+		uintptr_t base = reinterpret_cast<uintptr_t>(info.dli_saddr != nullptr ? info.dli_saddr : info.dli_fbase);
+		std::string name = info.dli_fname != nullptr ? info.dli_fname : "?";
+
+		if (info.dli_sname != nullptr)
+		{
+			int status = 0;
+			char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+			name = status == 0 ? demangled : info.dli_sname;
+			std::free(demangled);
+		}
+
+		return name + "+" + std::to_string(reinterpret_cast<uintptr_t>(address) - base);
+#endif
+	}
+
+	static std::string Escape(std::string_view text)
+	{
+		std::string result;
+
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\')
+			{
+				result.push_back('\\');
+			}
+
+			result.push_back(c);
+		}
+
+		return result;
+	}
+
+	// Defined below the class, the default member initializers of Phase and Site are not usable before
+	static Phase s_phases[MaxPhases];
+	inline static int s_phaseCount = 1;
+	inline static std::atomic<int> s_current = 0;
+	static Site s_sites[MaxSites];
+};
+
+// Phase 0 collects everything outside of timed phases
+inline AllocationProfiler::Phase AllocationProfiler::s_phases[MaxPhases]{ { "unscoped" } };
+inline AllocationProfiler::Site AllocationProfiler::s_sites[MaxSites]{};
+#endif
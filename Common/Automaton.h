@@ -0,0 +1,52 @@
+#pragma once
+#include "BinaryMachine.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Machine of any kind in the layout of the binary format. The arrays are either owned or borrowed
+// from a mapped binary file, so a machine is handed from one algorithm to the next by moving it.
+//   rowOffsets   NFA only, see BinaryHeader
+//   transitions  row-major states x inputs, -1 marks a missing transition
+//   outputs      Mealy: per transition, Moore: per state, empty otherwise
+struct Automaton
+{
+	MachineKind kind = MachineKind::Dfa;
+	size_t states = 0;
+	size_t inputs = 0;
+	MachineArray<uint64_t> rowOffsets;
+	MachineArray<int32_t> transitions;
+	MachineArray<int32_t> outputs;
+
+	size_t Cell(size_t state, size_t input) const
+	{
+		return state * inputs + input;
+	}
+};
+
+// Borrows every array from the mapped file, nothing is copied
+inline Automaton BorrowAutomaton(const BinaryMachine& machine)
+{
+	machine.Expect(machine.Header().kind);
+
+	Automaton automaton;
+	automaton.kind = machine.Header().kind;
+	automaton.states = static_cast<size_t>(machine.Header().states);
+	automaton.inputs = static_cast<size_t>(machine.Header().inputs);
+	automaton.rowOffsets = machine.Borrow(machine.RowOffsets());
+	automaton.transitions = machine.Borrow(machine.Transitions());
+	automaton.outputs = machine.Borrow(machine.Outputs());
+
+	return automaton;
+}
+
+inline void WriteBinaryMachine(const std::string& filename, const Automaton& automaton)
+{
+	BinaryHeader header;
+	header.kind = automaton.kind;
+	header.states = automaton.states;
+	header.inputs = automaton.inputs;
+
+	WriteBinaryMachine(filename, header, automaton.rowOffsets.View(), automaton.transitions.View(),
+		automaton.outputs.View());
+}
@@ -0,0 +1,341 @@
+#pragma once
+#include "MappedFile.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Binary automaton interchange format, version 1. All numbers are little endian.
+//
+//   BinaryHeader
+//   uint64_t rowOffsets[header.rowOffsetCount]   NFA only: transitions of state s on symbol a
+//                                                are [rowOffsets[s * inputs + a], rowOffsets[s * inputs + a + 1])
+//   int32_t  transitions[header.transitionCount]  target states, row-major states x inputs
+//                                                except for NFAs, -1 marks a missing transition
+//   int32_t  outputs[header.outputCount]          Mealy: per transition, Moore: per state
+//
+// Every array starts at a multiple of 8 bytes, so a mapped file is used in place.
+// BinaryMachine::Expect checks array sizes, target states and NFA row offsets before anything indexes by them.
+enum class MachineKind : uint8_t
+{
+	Mealy = 1,
+	Moore = 2,
+	Dfa = 3,
+	// inputs + 1 columns per state, the last one holds epsilon transitions
+	Nfa = 4,
+};
+
+constexpr int32_t NoTransition = -1;
+
+struct BinaryHeader
+{
+	char magic[4] = { 'A', 'U', 'T', 'M' };
+	uint16_t version = 1;
+	MachineKind kind = MachineKind::Mealy;
+	uint8_t indexWidth = sizeof(int32_t);
+	uint32_t flags = 0;
+	uint32_t reserved = 0;
+	uint64_t states = 0;
+	uint64_t inputs = 0;
+	uint64_t rowOffsetCount = 0;
+	uint64_t transitionCount = 0;
+	uint64_t outputCount = 0;
+};
+
+static_assert(sizeof(BinaryHeader) == 56);
+
+inline bool IsBinaryMachine(std::string_view data)
+{
+	return data.size() >= sizeof(BinaryHeader::magic) && std::memcmp(data.data(), "AUTM", 4) == 0;
+}
+
+// Array that either owns its elements or borrows them from a mapped binary machine.
+// Borrowed arrays keep the mapping alive and are copied before the first write.
+template <typename T>
+class MachineArray
+{
+public:
+	MachineArray() = default;
+
+	MachineArray(size_t size, T value)
+		: m_owned(size, value)
+		, m_data(m_owned.data())
+		, m_size(size)
+	{
+	}
+
+	// Takes over the elements, nothing is copied
+	explicit MachineArray(std::vector<T> items)
+		: m_owned(std::move(items))
+		, m_data(m_owned.data())
+		, m_size(m_owned.size())
+	{
+	}
+
+	MachineArray(std::span<const T> items, std::shared_ptr<const void> owner)
+		: m_owner(std::move(owner))
+		, m_data(items.data())
+		, m_size(items.size())
+	{
+	}
+
+	MachineArray(const MachineArray&) = delete;
+	MachineArray& operator=(const MachineArray&) = delete;
+
+	MachineArray(MachineArray&& other) noexcept = default;
+	MachineArray& operator=(MachineArray&& other) noexcept = default;
+
+	const T& operator[](size_t index) const
+	{
+		return m_data[index];
+	}
+
+	T& operator[](size_t index)
+	{
+		if (m_data != m_owned.data())
+		{
+			m_owned.assign(m_data, m_data + m_size);
+			m_data = m_owned.data();
+			m_owner.reset();
+		}
+
+		return m_owned[index];
+	}
+
+	const T* Data() const
+	{
+		return m_data;
+	}
+
+	size_t Size() const
+	{
+		return m_size;
+	}
+
+	std::span<const T> View() const
+	{
+		return { m_data, m_size };
+	}
+
+private:
+	std::vector<T> m_owned;
+	std::shared_ptr<const void> m_owner;
+	const T* m_data = nullptr;
+	size_t m_size = 0;
+};
+
+// Machine in the binary format mapped into memory, arrays point straight into the mapping
+class BinaryMachine
+{
+public:
+	explicit BinaryMachine(std::shared_ptr<const MappedFile> file)
+		: m_file(std::move(file))
+	{
+		std::string_view data = m_file->Data();
+
+		if (!IsBinaryMachine(data) || data.size() < sizeof(BinaryHeader))
+		{
+			throw std::runtime_error("Not a binary machine file");
+		}
+
+		std::memcpy(&m_header, data.data(), sizeof(BinaryHeader));
+
+		if (m_header.version != 1)
+		{
+			throw std::runtime_error("Unsupported binary machine version " + std::to_string(m_header.version));
+		}
+
+		if (m_header.indexWidth != sizeof(int32_t))
+		{
+			throw std::runtime_error("Unsupported index width " + std::to_string(m_header.indexWidth));
+		}
+
+		size_t offset = sizeof(BinaryHeader);
+		m_rowOffsets = Section<uint64_t>(data, offset, m_header.rowOffsetCount);
+		m_transitions = Section<int32_t>(data, offset, m_header.transitionCount);
+		m_outputs = Section<int32_t>(data, offset, m_header.outputCount);
+	}
+
+	const BinaryHeader& Header() const
+	{
+		return m_header;
+	}
+
+	std::span<const uint64_t> RowOffsets() const
+	{
+		return m_rowOffsets;
+	}
+
+	std::span<const int32_t> Transitions() const
+	{
+		return m_transitions;
+	}
+
+	std::span<const int32_t> Outputs() const
+	{
+		return m_outputs;
+	}
+
+	// Array over a section of the mapping that keeps the file mapped
+	template <typename T>
+	MachineArray<T> Borrow(std::span<const T> section) const
+	{
+		return MachineArray<T>(section, m_file);
+	}
+
+	// Checks that the machine is of the expected kind, its arrays have the matching sizes
+	// and every target state and NFA row offset is in range
+	void Expect(MachineKind kind) const
+	{
+		// The tools count states and inputs in int, which also keeps the cell counts from overflowing
+		bool valid = m_header.kind == kind && m_header.states <= INT_MAX && m_header.inputs <= INT_MAX;
+		uint64_t cells = m_header.states * m_header.inputs;
+
+		switch (kind)
+		{
+		case MachineKind::Mealy:
+			valid = valid && m_header.transitionCount == cells && m_header.outputCount == cells;
+			break;
+		case MachineKind::Moore:
+			valid = valid && m_header.transitionCount == cells && m_header.outputCount == m_header.states;
+			break;
+		case MachineKind::Dfa:
+			valid = valid && m_header.transitionCount == cells;
+			break;
+		case MachineKind::Nfa:
+			valid = valid && m_header.rowOffsetCount == m_header.states * (m_header.inputs + 1) + 1
+				&& m_rowOffsets.back() == m_header.transitionCount;
+			break;
+		}
+
+		if (!valid)
+		{
+			throw std::runtime_error("Binary machine is not a valid " + std::string(KindName(kind)));
+		}
+
+		ExpectTargets(kind == MachineKind::Nfa ? 0 : NoTransition);
+
+		if (kind == MachineKind::Nfa)
+		{
+			ExpectRowOffsets();
+		}
+	}
+
+	static const char* KindName(MachineKind kind)
+	{
+		switch (kind)
+		{
+		case MachineKind::Mealy:
+			return "Mealy machine";
+		case MachineKind::Moore:
+			return "Moore machine";
+		case MachineKind::Dfa:
+			return "DFA";
+		case MachineKind::Nfa:
+			return "NFA";
+		}
+
+		return "machine";
+	}
+
+private:
+	// Targets are states or, below lowest, nothing
+	void ExpectTargets(int32_t lowest) const
+	{
+		auto outOfRange = std::ranges::find_if(m_transitions, [lowest, states = m_header.states](int32_t target) {
+			return target < lowest || (target >= 0 && static_cast<uint64_t>(target) >= states);
+		});
+
+		if (outOfRange != m_transitions.end())
+		{
+			throw std::runtime_error("Transition " + std::to_string(outOfRange - m_transitions.begin())
+				+ ": state " + std::to_string(*outOfRange) + " is out of range");
+		}
+	}
+
+	// Rows start at zero and never go back, so they all lie within the transitions
+	void ExpectRowOffsets() const
+	{
+		auto decrease = std::ranges::adjacent_find(m_rowOffsets, std::ranges::greater());
+
+		if (m_rowOffsets.front() != 0 || decrease != m_rowOffsets.end())
+		{
+			size_t row = decrease != m_rowOffsets.end() ? decrease - m_rowOffsets.begin() + 1 : 0;
+
+			throw std::runtime_error("Row " + std::to_string(row) + ": offset "
+				+ std::to_string(m_rowOffsets[row]) + " is out of range");
+		}
+	}
+
+	template <typename T>
+	static std::span<const T> Section(std::string_view data, size_t& offset, uint64_t count)
+	{
+		offset = (offset + 7) / 8 * 8;
+
+		if (count > (data.size() - std::min(offset, data.size())) / sizeof(T))
+		{
+			throw std::runtime_error("Binary machine file is truncated");
+		}
+
+		std::span<const T> section(reinterpret_cast<const T*>(data.data() + offset), count);
+		offset += count * sizeof(T);
+
+		return section;
+	}
+
+	std::shared_ptr<const MappedFile> m_file;
+	BinaryHeader m_header;
+	std::span<const uint64_t> m_rowOffsets;
+	std::span<const int32_t> m_transitions;
+	std::span<const int32_t> m_outputs;
+};
+
+inline void WriteBinaryMachine(const std::string& filename, BinaryHeader header,
+	std::span<const uint64_t> rowOffsets, std::span<const int32_t> transitions, std::span<const int32_t> outputs)
+{
+	std::ofstream file(filename, std::ios::binary);
+
+	if (!file.is_open())
+	{
+		throw std::runtime_error("Unable to create file " + filename);
+	}
+
+	header.rowOffsetCount = rowOffsets.size();
+	header.transitionCount = transitions.size();
+	header.outputCount = outputs.size();
+
+	auto write = [&file](const void* data, size_t size) {
+		static const char padding[8]{};
+
+		file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+		file.write(padding, static_cast<std::streamsize>((8 - size % 8) % 8));
+	};
+
+	write(&header, sizeof(header));
+	write(rowOffsets.data(), rowOffsets.size_bytes());
+	write(transitions.data(), transitions.size_bytes());
+	write(outputs.data(), outputs.size_bytes());
+
+	if (!file)
+	{
+		throw std::runtime_error("Unable to write file " + filename);
+	}
+}
+
+inline void WriteBinaryMachine(const std::string& filename, MachineKind kind, uint64_t states, uint64_t inputs,
+	std::span<const int32_t> transitions, std::span<const int32_t> outputs = {})
+{
+	BinaryHeader header;
+	header.kind = kind;
+	header.states = states;
+	header.inputs = inputs;
+
+	WriteBinaryMachine(filename, header, {}, transitions, outputs);
+}
@@ -0,0 +1,331 @@
+#pragma once
+#include "Automaton.h"
+#include "BinaryMachine.h"
+#include "MappedFile.h"
+#include "OutputBuffer.h"
+#include "TextScanner.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Text formats read by the tools:
+//   mealy        Lab1/Lab1 input, "S1 Y2, -, S0 Y1"
+//   moore        Lab1/MooreToMealy input, "Y1 q2 - q0"
+//   mealy-table  Lab2/MinimizeMealy input, "1 2 - 0 1"
+//   moore-table  Lab2/MinimizeMoore input, "1 2 - 0"
+//   nfa          Lab3 input, "1,2 - 0" with the epsilon column last
+//   dfa          Lab3 output, "1 - 0" without a header
+enum class TextFormat
+{
+	Mealy,
+	Moore,
+	MealyTable,
+	MooreTable,
+	Nfa,
+	Dfa,
+};
+
+inline const std::map<std::string, TextFormat>& TextFormatNames()
+{
+	static const std::map<std::string, TextFormat> names{
+		{ "mealy", TextFormat::Mealy },
+		{ "moore", TextFormat::Moore },
+		{ "mealy-table", TextFormat::MealyTable },
+		{ "moore-table", TextFormat::MooreTable },
+		{ "nfa", TextFormat::Nfa },
+		{ "dfa", TextFormat::Dfa },
+	};
+
+	return names;
+}
+
+inline MachineKind KindOf(TextFormat format)
+{
+	switch (format)
+	{
+	case TextFormat::Mealy:
+	case TextFormat::MealyTable:
+		return MachineKind::Mealy;
+	case TextFormat::Moore:
+	case TextFormat::MooreTable:
+		return MachineKind::Moore;
+	case TextFormat::Nfa:
+		return MachineKind::Nfa;
+	default:
+		return MachineKind::Dfa;
+	}
+}
+
+inline int32_t ReadState(TextScanner& scanner, uint64_t states)
+{
+	int32_t state = scanner.ReadNumber<int32_t>();
+
+	if (state < 0 || static_cast<uint64_t>(state) >= states)
+	{
+		scanner.Fail("state " + std::to_string(state) + " is out of range");
+	}
+
+	return state;
+}
+
+inline size_t CountTokens(std::string_view line)
+{
+	size_t count = 0;
+	bool inToken = false;
+
+	for (char c : line)
+	{
+		bool space = std::isspace(static_cast<unsigned char>(c));
+		count += !space && !inToken ? 1 : 0;
+		inToken = !space;
+	}
+
+	return count;
+}
+
+inline Automaton ReadText(TextFormat format, TextScanner& scanner)
+{
+	uint64_t states = 0;
+	uint64_t inputs = 0;
+	std::vector<uint64_t> rowOffsets;
+	std::vector<int32_t> transitions;
+	std::vector<int32_t> outputs;
+	MachineKind kind = KindOf(format);
+
+	scanner.SkipWhitespace();
+
+	if (format == TextFormat::Dfa)
+	{
+		// No header, every non-blank line is a state and the first one tells the number of inputs
+		std::string_view rest = scanner.Rest();
+		inputs = CountTokens(rest.substr(0, rest.find('\n')));
+
+		while (!rest.empty())
+		{
+			size_t lineEnd = std::min(rest.find('\n'), rest.size());
+			states += CountTokens(rest.substr(0, lineEnd)) != 0 ? 1 : 0;
+			rest.remove_prefix(std::min(lineEnd + 1, rest.size()));
+		}
+	}
+	else
+	{
+		states = scanner.ReadNumber<uint64_t>();
+		scanner.SkipSpaces();
+		inputs = scanner.ReadNumber<uint64_t>();
+		scanner.ExpectLineEnd();
+	}
+
+	size_t cols = format == TextFormat::Nfa ? inputs + 1 : inputs;
+
+	if (format == TextFormat::Nfa)
+	{
+		rowOffsets.reserve(states * cols + 1);
+		rowOffsets.push_back(0);
+	}
+	else
+	{
+		transitions.assign(states * inputs, NoTransition);
+	}
+
+	if (kind == MachineKind::Mealy)
+	{
+		outputs.assign(states * inputs, -1);
+	}
+	else if (kind == MachineKind::Moore)
+	{
+		outputs.assign(states, 0);
+	}
+
+	for (size_t i = 0; i < states; i++)
+	{
+		scanner.SkipWhitespace();
+
+		if (format == TextFormat::Moore)
+		{
+			scanner.Expect('Y');
+		}
+
+		if (kind == MachineKind::Moore)
+		{
+			outputs[i] = scanner.ReadNumber<int32_t>();
+		}
+
+		for (size_t j = 0; j < cols; j++)
+		{
+			size_t cell = i * inputs + j;
+
+			if (format == TextFormat::Mealy && j != 0)
+			{
+				scanner.SkipSpaces();
+				scanner.Expect(',');
+			}
+
+			scanner.SkipSpaces();
+
+			// Lab1 Mealy cells are followed by a comma, so "-" is never a standalone token there
+			bool missing = format == TextFormat::Mealy ? scanner.Peek() == '-' : scanner.SkipStandalone('-');
+
+			if (missing)
+			{
+				if (format == TextFormat::Mealy)
+				{
+					scanner.Advance();
+				}
+
+				if (format == TextFormat::Nfa)
+				{
+					rowOffsets.push_back(transitions.size());
+				}
+
+				continue;
+			}
+
+			switch (format)
+			{
+			case TextFormat::Mealy:
+				scanner.Expect('S');
+				transitions[cell] = ReadState(scanner, states);
+				scanner.SkipSpaces();
+				scanner.Expect('Y');
+				outputs[cell] = scanner.ReadNumber<int32_t>();
+				break;
+			case TextFormat::MealyTable:
+				transitions[cell] = ReadState(scanner, states);
+				scanner.SkipSpaces();
+				outputs[cell] = scanner.ReadNumber<int32_t>();
+				break;
+			case TextFormat::Moore:
+				scanner.Expect('q');
+				transitions[cell] = ReadState(scanner, states);
+				break;
+			case TextFormat::MooreTable:
+			case TextFormat::Dfa:
+				transitions[cell] = ReadState(scanner, states);
+				break;
+			case TextFormat::Nfa:
+				transitions.push_back(ReadState(scanner, states));
+
+				while (scanner.Peek() == ',')
+				{
+					scanner.Advance();
+					transitions.push_back(ReadState(scanner, states));
+				}
+
+				rowOffsets.push_back(transitions.size());
+				break;
+			}
+		}
+
+		scanner.ExpectLineEnd();
+	}
+
+	Automaton automaton;
+	automaton.kind = kind;
+	automaton.states = static_cast<size_t>(states);
+	automaton.inputs = static_cast<size_t>(inputs);
+	automaton.rowOffsets = MachineArray<uint64_t>(std::move(rowOffsets));
+	automaton.transitions = MachineArray<int32_t>(std::move(transitions));
+	automaton.outputs = MachineArray<int32_t>(std::move(outputs));
+
+	return automaton;
+}
+
+// Reads a machine in the given text format or in the binary format, which is used in place
+inline Automaton ReadAutomaton(const std::shared_ptr<const MappedFile>& file, TextFormat format)
+{
+	if (IsBinaryMachine(file->Data()))
+	{
+		BinaryMachine machine(file);
+		machine.Expect(KindOf(format));
+
+		return BorrowAutomaton(machine);
+	}
+
+	TextScanner scanner(file->Data());
+
+	return ReadText(format, scanner);
+}
+
+inline void WriteText(TextFormat format, const Automaton& automaton, OutputBuffer& out)
+{
+	if (KindOf(format) != automaton.kind)
+	{
+		throw std::runtime_error("Machine cannot be written in this text format");
+	}
+
+	size_t states = automaton.states;
+	size_t inputs = automaton.inputs;
+	const MachineArray<uint64_t>& offsets = automaton.rowOffsets;
+	const MachineArray<int32_t>& transitions = automaton.transitions;
+	const MachineArray<int32_t>& outputs = automaton.outputs;
+
+	if (format != TextFormat::Dfa)
+	{
+		out << states << " " << inputs << '\n';
+	}
+
+	for (size_t i = 0; i < states; i++)
+	{
+		if (format == TextFormat::Moore)
+		{
+			out << "Y" << outputs[i] << " ";
+		}
+		else if (format == TextFormat::MooreTable)
+		{
+			out << outputs[i] << " ";
+		}
+
+		for (size_t j = 0; j < (format == TextFormat::Nfa ? inputs + 1 : inputs); j++)
+		{
+			size_t cell = i * inputs + j;
+
+			if (format == TextFormat::Mealy && j != 0)
+			{
+				out << ", ";
+			}
+
+			if (format == TextFormat::Nfa)
+			{
+				size_t row = i * (inputs + 1) + j;
+
+				for (uint64_t k = offsets[row]; k < offsets[row + 1]; k++)
+				{
+					out << (k != offsets[row] ? "," : "") << transitions[k];
+				}
+
+				out << (offsets[row] == offsets[row + 1] ? "- " : " ");
+				continue;
+			}
+
+			if (transitions[cell] == NoTransition)
+			{
+				out << (format == TextFormat::Mealy ? "-" : "- ");
+				continue;
+			}
+
+			switch (format)
+			{
+			case TextFormat::Mealy:
+				out << "S" << transitions[cell] << " Y" << outputs[cell];
+				break;
+			case TextFormat::MealyTable:
+				out << transitions[cell] << " " << outputs[cell] << " ";
+				break;
+			case TextFormat::Moore:
+				out << "q" << transitions[cell] << " ";
+				break;
+			default:
+				out << transitions[cell] << " ";
+				break;
+			}
+		}
+
+		out << '\n';
+	}
+}
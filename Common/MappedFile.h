@@ -0,0 +1,128 @@
+#pragma once
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only view of a whole file mapped into memory
+class MappedFile
+{
+public:
+	explicit MappedFile(const std::string& filename)
+	{
+#ifdef _WIN32
+		m_file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+		if (m_file == INVALID_HANDLE_VALUE)
+		{
+			throw std::runtime_error("Unable to open file " + filename);
+		}
+
+		LARGE_INTEGER size{};
+		GetFileSizeEx(m_file, &size);
+		m_size = static_cast<size_t>(size.QuadPart);
+
+		if (m_size != 0)
+		{
+			m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			m_data = m_mapping != nullptr
+				? static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0))
+				: nullptr;
+
+			if (m_data == nullptr)
+			{
+				Close();
+				throw std::runtime_error("Unable to map file " + filename);
+			}
+		}
+#else
+		m_file = open(filename.c_str(), O_RDONLY);
+
+		if (m_file == -1)
+		{
+			throw std::runtime_error("Unable to open file " + filename);
+		}
+
+		struct stat info{};
+		fstat(m_file, &info);
+		m_size = static_cast<size_t>(info.st_size);
+
+		if (m_size != 0)
+		{
+			void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+
+			if (data == MAP_FAILED)
+			{
+				Close();
+				throw std::runtime_error("Unable to map file " + filename);
+			}
+
+			m_data = static_cast<const char*>(data);
+			madvise(data, m_size, MADV_SEQUENTIAL);
+		}
+#endif
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	~MappedFile()
+	{
+		Close();
+	}
+
+	std::string_view Data() const
+	{
+		return { m_data, m_size };
+	}
+
+private:
+	void Close()
+	{
+#ifdef _WIN32
+		if (m_data != nullptr)
+		{
+			UnmapViewOfFile(m_data);
+		}
+
+		if (m_mapping != nullptr)
+		{
+			CloseHandle(m_mapping);
+		}
+
+		CloseHandle(m_file);
+#else
+		if (m_data != nullptr)
+		{
+			munmap(const_cast<char*>(m_data), m_size);
+		}
+
+		close(m_file);
+#endif
+		m_data = nullptr;
+	}
+
+#ifdef _WIN32
+	HANDLE m_file = INVALID_HANDLE_VALUE;
+	HANDLE m_mapping = nullptr;
+#else
+	int m_file = -1;
+#endif
+	const char* m_data = nullptr;
+	size_t m_size = 0;
+};
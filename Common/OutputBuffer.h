@@ -0,0 +1,223 @@
+#pragma once
+#include "Parallel.h"
+#include <charconv>
+#include <concepts>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <climits>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+// Writes the blocks in order with as few calls as possible.
+// Standard output is written with writev straight to the descriptor once std::cout is flushed.
+inline void WriteBlocks(std::ostream& stream, std::span<const std::string_view> blocks)
+{
+#ifndef _WIN32
+	if (&stream == &std::cout)
+	{
+		std::cout.flush();
+
+		std::vector<iovec> vectors;
+		vectors.reserve(blocks.size());
+
+		for (std::string_view block : blocks)
+		{
+			if (!block.empty())
+			{
+				vectors.push_back({ const_cast<char*>(block.data()), block.size() });
+			}
+		}
+
+		size_t next = 0;
+
+		while (next < vectors.size())
+		{
+			int count = static_cast<int>(std::min<size_t>(vectors.size() - next, IOV_MAX));
+			ssize_t written = writev(STDOUT_FILENO, vectors.data() + next, count);
+
+			if (written < 0 && errno == EINTR)
+			{
+				continue;
+			}
+
+			if (written < 0)
+			{
+				stream.setstate(std::ios::badbit);
+				return;
+			}
+
+			while (next < vectors.size() && static_cast<size_t>(written) >= vectors[next].iov_len)
+			{
+				written -= vectors[next++].iov_len;
+			}
+
+			if (next < vectors.size())
+			{
+				vectors[next].iov_base = static_cast<char*>(vectors[next].iov_base) + written;
+				vectors[next].iov_len -= written;
+			}
+		}
+
+		return;
+	}
+#endif
+
+	for (std::string_view block : blocks)
+	{
+		stream.write(block.data(), static_cast<std::streamsize>(block.size()));
+	}
+}
+
+// Flushes the stream and throws if any write to it failed, so a tool does not exit 0 after losing output
+inline void CheckOutput(std::ostream& stream = std::cout)
+{
+	stream.flush();
+
+	if (!stream)
+	{
+		throw std::runtime_error("Unable to write the output");
+	}
+}
+
+// Formats text into a large reusable buffer, numbers are formatted with std::to_chars.
+// A buffer bound to a stream hands its content over whenever it grows past the capacity
+// and when it is destroyed, an unbound one just accumulates text.
+class OutputBuffer
+{
+public:
+	OutputBuffer() = default;
+
+	explicit OutputBuffer(std::ostream& stream, size_t capacity = size_t{ 1 } << 20)
+		: m_stream(&stream)
+		, m_capacity(capacity)
+	{
+		m_data.reserve(capacity + 64);
+	}
+
+	OutputBuffer(const OutputBuffer&) = delete;
+	OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+	~OutputBuffer()
+	{
+		Flush();
+	}
+
+	OutputBuffer& operator<<(std::string_view text)
+	{
+		m_data.append(text);
+		return Check();
+	}
+
+	OutputBuffer& operator<<(const char* text)
+	{
+		return *this << std::string_view(text);
+	}
+
+	OutputBuffer& operator<<(char c)
+	{
+		m_data.push_back(c);
+		return Check();
+	}
+
+	template <std::integral T>
+	OutputBuffer& operator<<(T value)
+	{
+		char digits[24];
+		auto [end, error] = std::to_chars(digits, digits + sizeof(digits), value);
+		m_data.append(digits, end);
+
+		return Check();
+	}
+
+	std::string_view View() const
+	{
+		return m_data;
+	}
+
+	void Clear()
+	{
+		m_data.clear();
+	}
+
+	void Flush()
+	{
+		if (m_stream != nullptr && !m_data.empty())
+		{
+			std::string_view block = m_data;
+			WriteBlocks(*m_stream, { &block, 1 });
+			m_data.clear();
+		}
+	}
+
+private:
+	OutputBuffer& Check()
+	{
+		if (m_data.size() >= m_capacity)
+		{
+			Flush();
+		}
+
+		return *this;
+	}
+
+	std::ostream* m_stream = nullptr;
+	size_t m_capacity = static_cast<size_t>(-1);
+	std::string m_data;
+};
+
+// Formats rows [0, rows) with formatRow(row, buffer) and writes them in order.
+// Blocks of rows are formatted concurrently into per-block buffers, so the output
+// is byte-for-byte the same for any number of threads.
+template <typename FormatRow>
+void WriteRowsParallel(std::ostream& stream, size_t rows, int threads, FormatRow&& formatRow)
+{
+	if (threads <= 1)
+	{
+		OutputBuffer buffer(stream);
+
+		for (size_t row = 0; row < rows; row++)
+		{
+			formatRow(row, buffer);
+		}
+
+		return;
+	}
+
+	const size_t blockRows = 16384;
+	size_t blocks = (rows + blockRows - 1) / blockRows;
+
+	std::vector<OutputBuffer> buffers(threads);
+	std::vector<std::string_view> views(threads);
+
+	for (size_t first = 0; first < blocks; first += threads)
+	{
+		size_t count = std::min<size_t>(threads, blocks - first);
+
+		ParallelFor(threads, count, [&](size_t begin, size_t end) {
+			for (size_t block = begin; block < end; block++)
+			{
+				OutputBuffer& buffer = buffers[block];
+				buffer.Clear();
+
+				size_t lastRow = std::min(rows, (first + block + 1) * blockRows);
+
+				for (size_t row = (first + block) * blockRows; row < lastRow; row++)
+				{
+					formatRow(row, buffer);
+				}
+
+				views[block] = buffer.View();
+			}
+		});
+
+		WriteBlocks(stream, std::span(views.data(), count));
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+// Calls fn(begin, end) for consecutive ranges of [0, count) on the given number of threads
+template <typename Fn>
+void ParallelFor(int threads, size_t count, Fn&& fn)
+{
+	size_t chunks = std::min(static_cast<size_t>(std::max(threads, 1)), std::max<size_t>(count, 1));
+
+	if (chunks == 1)
+	{
+		fn(size_t{ 0 }, count);
+		return;
+	}
+
+	std::vector<std::thread> workers;
+	workers.reserve(chunks - 1);
+
+	for (size_t i = 1; i < chunks; i++)
+	{
+		workers.emplace_back([&fn, i, chunks, count] {
+			fn(count * i / chunks, count * (i + 1) / chunks);
+		});
+	}
+
+	fn(size_t{ 0 }, count / chunks);
+
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+// Sorts chunks concurrently and then merges pairs of them level by level.
+// buffer and bounds are scratch space, nothing is allocated once they have grown enough.
+template <typename T, typename Less>
+void ParallelSort(std::vector<T>& items, std::vector<T>& buffer, std::vector<size_t>& bounds,
+	int threads, Less less)
+{
+	size_t count = items.size();
+	size_t chunks = std::min(static_cast<size_t>(std::max(threads, 1)), std::max<size_t>(count, 1));
+
+	bounds.resize(chunks + 1);
+	buffer.resize(count);
+
+	for (size_t i = 0; i <= chunks; i++)
+	{
+		bounds[i] = count * i / chunks;
+	}
+
+	ParallelFor(static_cast<int>(chunks), chunks, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+		{
+			std::sort(items.begin() + bounds[i], items.begin() + bounds[i + 1], less);
+		}
+	});
+
+	while (bounds.size() > 2)
+	{
+		size_t last = bounds.size() - 1;
+		size_t merges = bounds.size() / 2;
+
+		ParallelFor(static_cast<int>(merges), merges, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+			{
+				auto first = items.begin() + bounds[2 * i];
+				auto middle = items.begin() + bounds[std::min(2 * i + 1, last)];
+				auto stop = items.begin() + bounds[std::min(2 * i + 2, last)];
+
+				std::merge(first, middle, middle, stop, buffer.begin() + bounds[2 * i], less);
+			}
+		});
+
+		items.swap(buffer);
+
+		for (size_t i = 0; i < merges; i++)
+		{
+			bounds[i] = bounds[2 * i];
+		}
+
+		bounds[merges] = count;
+		bounds.resize(merges + 1);
+	}
+}
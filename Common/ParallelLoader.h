@@ -0,0 +1,98 @@
+#pragma once
+#include "Parallel.h"
+#include "TextScanner.h"
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Parses the first rows non-blank lines of scanner's remaining text, one table row per line.
+// The text is cut at line breaks into one range per thread. The first pass counts rows
+// in every range, the second one parses every range starting from its first row index,
+// so parseRow(row, scanner) can write straight into a preallocated table.
+template <typename ParseRow>
+void ParseRowsParallel(const TextScanner& scanner, size_t rows, int threads, ParseRow&& parseRow)
+{
+	std::string_view text = scanner.Rest();
+	size_t chunks = std::max<size_t>(1, std::min(static_cast<size_t>(std::max(threads, 1)), text.size() / 4096 + 1));
+
+	std::vector<size_t> bounds(chunks + 1, text.size());
+	bounds[0] = 0;
+
+	for (size_t i = 1; i < chunks; i++)
+	{
+		size_t position = std::max(text.size() * i / chunks, bounds[i - 1]);
+		size_t lineBreak = text.find('\n', position);
+		bounds[i] = lineBreak == std::string_view::npos ? text.size() : lineBreak + 1;
+	}
+
+	auto isBlank = [](std::string_view line) {
+		return line.find_first_not_of(" \t\r\v\f") == std::string_view::npos;
+	};
+
+	std::vector<size_t> firstRow(chunks + 1, 0);
+
+	ParallelFor(static_cast<int>(chunks), chunks, [&](size_t begin, size_t end) {
+		for (size_t chunk = begin; chunk < end; chunk++)
+		{
+			const char* current = text.data() + bounds[chunk];
+			const char* last = text.data() + bounds[chunk + 1];
+			size_t count = 0;
+
+			while (current != last)
+			{
+				const char* lineBreak = static_cast<const char*>(std::memchr(current, '\n', last - current));
+				const char* lineEnd = lineBreak != nullptr ? lineBreak : last;
+
+				count += isBlank({ current, static_cast<size_t>(lineEnd - current) }) ? 0 : 1;
+				current = lineBreak != nullptr ? lineBreak + 1 : last;
+			}
+
+			firstRow[chunk + 1] = count;
+		}
+	});
+
+	for (size_t i = 1; i <= chunks; i++)
+	{
+		firstRow[i] += firstRow[i - 1];
+	}
+
+	if (firstRow[chunks] < rows)
+	{
+		throw std::runtime_error("Expected " + std::to_string(rows) + " rows, found "
+			+ std::to_string(firstRow[chunks]));
+	}
+
+	std::vector<std::exception_ptr> errors(chunks);
+
+	ParallelFor(static_cast<int>(chunks), chunks, [&](size_t begin, size_t end) {
+		for (size_t chunk = begin; chunk < end && firstRow[chunk] < rows; chunk++)
+		{
+			try
+			{
+				TextScanner rowScanner(text.substr(bounds[chunk], bounds[chunk + 1] - bounds[chunk]), scanner.Origin());
+
+				for (size_t row = firstRow[chunk]; row < std::min(firstRow[chunk + 1], rows); row++)
+				{
+					rowScanner.SkipWhitespace();
+					parseRow(row, rowScanner);
+					rowScanner.ExpectLineEnd();
+				}
+			}
+			catch (...)
+			{
+				errors[chunk] = std::current_exception();
+			}
+		}
+	});
+
+	for (const auto& error : errors)
+	{
+		if (error)
+		{
+			std::rethrow_exception(error);
+		}
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+
+// SplitMix64, the same seed gives the same numbers on every platform and compiler
+class Random
+{
+public:
+	explicit Random(uint64_t seed)
+		: m_state(seed)
+	{
+	}
+
+	// Independent generator for a key, e.g. the same numbers for a class wherever it is used
+	static Random ForKey(uint64_t seed, uint64_t key)
+	{
+		return Random(Mix(seed ^ Mix(key + 1)));
+	}
+
+	static uint64_t Mix(uint64_t z)
+	{
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+		return z ^ (z >> 31);
+	}
+
+	uint64_t Next()
+	{
+		return Mix(m_state += 0x9E3779B97F4A7C15);
+	}
+
+	// Uniform in [0, bound)
+	int Below(int bound)
+	{
+		return static_cast<int>((Next() >> 32) * static_cast<uint64_t>(bound) >> 32);
+	}
+
+	// True with the given probability
+	bool Chance(double probability)
+	{
+		return static_cast<double>(Next() >> 11) * 0x1.0p-53 < probability;
+	}
+
+private:
+	uint64_t m_state;
+};
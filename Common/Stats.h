@@ -0,0 +1,224 @@
+#pragma once
+#include "AllocationProfiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Peak resident memory of the process so far
+inline long long PeakMemoryKb()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters{};
+	GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+	return static_cast<long long>(counters.PeakWorkingSetSize / 1024);
+#else
+	rusage usage{};
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+#endif
+}
+
+// Process-wide timings, counters, high-water marks and per-round series for --stats.
+// Nothing is recorded until Enable is called, so instrumented code pays one branch per call.
+// Calls are meant for phase and round boundaries, not for per-cell work.
+class Stats
+{
+public:
+	static void Enable()
+	{
+		s_enabled = true;
+	}
+
+	static bool Enabled()
+	{
+		return s_enabled;
+	}
+
+	static void AddTime(std::string_view name, double seconds)
+	{
+		if (s_enabled)
+		{
+			Update(Kind::Timer, name, [seconds](Entry& entry) { entry.seconds += seconds; });
+		}
+	}
+
+	static void Count(std::string_view name, int64_t amount = 1)
+	{
+		if (s_enabled)
+		{
+			Update(Kind::Counter, name, [amount](Entry& entry) { entry.value += amount; });
+		}
+	}
+
+	static void Max(std::string_view name, int64_t value)
+	{
+		if (s_enabled)
+		{
+			Update(Kind::Maximum, name, [value](Entry& entry) { entry.value = std::max(entry.value, value); });
+		}
+	}
+
+	static void Sample(std::string_view name, int64_t value)
+	{
+		if (s_enabled)
+		{
+			Update(Kind::Series, name, [value](Entry& entry) { entry.series.push_back(value); });
+		}
+	}
+
+	// {"timers": {...}, "counters": {...}, "maxima": {...}, "series": {...}, "peak_rss_kb": N},
+	// a PROFILE_ALLOCATIONS build adds "allocations": {"phases": {...}, "top_sites": [...]}
+	static void Write(std::ostream& stream)
+	{
+		std::lock_guard lock(s_mutex);
+		const char* sections[] = { "timers", "counters", "maxima", "series" };
+
+		stream << '{';
+
+		for (int kind = 0; kind < 4; kind++)
+		{
+			stream << '"' << sections[kind] << "\": {";
+			bool first = true;
+
+			for (const Entry& entry : s_entries)
+			{
+				if (static_cast<int>(entry.kind) != kind)
+				{
+					continue;
+				}
+
+				stream << (first ? "" : ", ") << '"' << entry.name << "\": ";
+				first = false;
+
+				if (entry.kind == Kind::Timer)
+				{
+					stream << entry.seconds;
+				}
+				else if (entry.kind == Kind::Series)
+				{
+					stream << '[';
+
+					for (size_t i = 0; i < entry.series.size(); i++)
+					{
+						stream << (i == 0 ? "" : ", ") << entry.series[i];
+					}
+
+					stream << ']';
+				}
+				else
+				{
+					stream << entry.value;
+				}
+			}
+
+			stream << "}, ";
+		}
+
+		stream << "\"peak_rss_kb\": " << PeakMemoryKb();
+#ifdef PROFILE_ALLOCATIONS
+		stream << ", \"allocations\": {";
+		AllocationProfiler::Write(stream);
+		stream << '}';
+#endif
+		stream << '}' << std::endl;
+	}
+
+private:
+	enum class Kind
+	{
+		Timer,
+		Counter,
+		Maximum,
+		Series,
+	};
+
+	struct Entry
+	{
+		Kind kind;
+		std::string name;
+		double seconds = 0;
+		int64_t value = 0;
+		std::vector<int64_t> series;
+	};
+
+	// Entries keep the order they were first recorded in, there are only a few of them
+	template <typename Fn>
+	static void Update(Kind kind, std::string_view name, Fn&& fn)
+	{
+		std::lock_guard lock(s_mutex);
+
+		for (Entry& entry : s_entries)
+		{
+			if (entry.kind == kind && entry.name == name)
+			{
+				fn(entry);
+				return;
+			}
+		}
+
+		s_entries.push_back(Entry{ kind, std::string(name), 0, 0, {} });
+		fn(s_entries.back());
+	}
+
+	inline static bool s_enabled = false;
+	inline static std::mutex s_mutex;
+	inline static std::vector<Entry> s_entries;
+};
+
+// Adds the time between construction and destruction to a timer.
+// In a PROFILE_ALLOCATIONS build the timer also names the phase allocations are charged to.
+class ScopedTimer
+{
+public:
+	explicit ScopedTimer(std::string_view name)
+		: m_name(name)
+	{
+#ifdef PROFILE_ALLOCATIONS
+		m_previousPhase = AllocationProfiler::EnterPhase(name);
+#endif
+		if (Stats::Enabled())
+		{
+			m_start = std::chrono::steady_clock::now();
+		}
+	}
+
+	ScopedTimer(const ScopedTimer&) = delete;
+	ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+	~ScopedTimer()
+	{
+#ifdef PROFILE_ALLOCATIONS
+		// Left first, so the bookkeeping of the timer is not charged to the phase
+		AllocationProfiler::LeavePhase(m_previousPhase);
+#endif
+		if (Stats::Enabled())
+		{
+			Stats::AddTime(m_name, std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count());
+		}
+	}
+
+private:
+	std::string_view m_name;
+	std::chrono::steady_clock::time_point m_start;
+#ifdef PROFILE_ALLOCATIONS
+	int m_previousPhase = 0;
+#endif
+};
@@ -0,0 +1,151 @@
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Allocation-free tokenizer over an in-memory text.
+// Line and column of a failure are only computed when the error is thrown.
+class TextScanner
+{
+public:
+	explicit TextScanner(std::string_view text)
+		: TextScanner(text, text.data())
+	{
+	}
+
+	// Scans a part of a larger text, errors are reported relative to origin
+	TextScanner(std::string_view text, const char* origin)
+		: m_begin(origin)
+		, m_current(text.data())
+		, m_end(text.data() + text.size())
+	{
+	}
+
+	const char* Origin() const
+	{
+		return m_begin;
+	}
+
+	std::string_view Rest() const
+	{
+		return { m_current, static_cast<size_t>(m_end - m_current) };
+	}
+
+	bool AtEnd() const
+	{
+		return m_current == m_end;
+	}
+
+	char Peek() const
+	{
+		return m_current != m_end ? *m_current : '\0';
+	}
+
+	void Advance()
+	{
+		++m_current;
+	}
+
+	// Skips spaces, tabs and carriage returns but stays on the current line
+	void SkipSpaces()
+	{
+		while (m_current != m_end && (*m_current == ' ' || *m_current == '\t' || *m_current == '\r'))
+		{
+			++m_current;
+		}
+	}
+
+	void SkipWhitespace()
+	{
+		while (m_current != m_end && std::string_view(" \t\r\n\v\f").find(*m_current) != std::string_view::npos)
+		{
+			++m_current;
+		}
+	}
+
+	// Skips the rest of the current line including the line break
+	void SkipLine()
+	{
+		m_current = std::find(m_current, m_end, '\n');
+
+		if (m_current != m_end)
+		{
+			++m_current;
+		}
+	}
+
+	// Consumes the character if it forms a whole token, so "-" is consumed but "-1" is not
+	bool SkipStandalone(char c)
+	{
+		if (Peek() != c || (m_current + 1 != m_end && !std::isspace(static_cast<unsigned char>(m_current[1]))))
+		{
+			return false;
+		}
+
+		++m_current;
+		return true;
+	}
+
+	void Expect(char expected)
+	{
+		if (Peek() != expected)
+		{
+			Fail(AtEnd() ? "unexpected end of file" : std::string("expected '") + expected + "'");
+		}
+
+		++m_current;
+	}
+
+	// Expects the end of the line (or of the text) after optional spaces
+	void ExpectLineEnd()
+	{
+		SkipSpaces();
+
+		if (m_current != m_end && *m_current != '\n')
+		{
+			Fail("expected end of line");
+		}
+
+		if (m_current != m_end)
+		{
+			++m_current;
+		}
+	}
+
+	template <typename T>
+	T ReadNumber()
+	{
+		T value{};
+		auto [end, error] = std::from_chars(m_current, m_end, value);
+
+		if (error != std::errc())
+		{
+			Fail(AtEnd() ? "unexpected end of file" : "expected a number");
+		}
+
+		m_current = end;
+		return value;
+	}
+
+	[[noreturn]] void Fail(const std::string& message) const
+	{
+		size_t line = 1 + std::count(m_begin, m_current, '\n');
+		const char* lineStart = m_current;
+
+		while (lineStart != m_begin && lineStart[-1] != '\n')
+		{
+			--lineStart;
+		}
+
+		throw std::runtime_error("Line " + std::to_string(line) + ", column "
+			+ std::to_string(m_current - lineStart + 1) + ": " + message);
+	}
+
+private:
+	const char* m_begin;
+	const char* m_current;
+	const char* m_end;
+};
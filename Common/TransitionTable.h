@@ -0,0 +1,179 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+enum class StorageKind
+{
+	Dense,
+	Sparse,
+};
+
+// rows x cols table of optional cells.
+// Sparse tables keep only present cells in compressed sparse row form
+// (row offsets, column indices, values), dense tables keep every cell and a presence flag.
+// FromRows picks whichever of the two takes less memory for the measured density.
+template <typename T>
+class TransitionTable
+{
+public:
+	TransitionTable() = default;
+
+	// rowOffsets has rows + 1 entries, cells of row i are [rowOffsets[i], rowOffsets[i + 1])
+	// and go in ascending column order
+	static TransitionTable FromRows(size_t rows, size_t cols, std::vector<size_t> rowOffsets,
+		std::vector<uint32_t> columns, std::vector<T> values)
+	{
+		TransitionTable table;
+		table.m_rows = rows;
+		table.m_cols = cols;
+
+		size_t denseBytes = rows * cols * (sizeof(T) + sizeof(uint8_t));
+		size_t sparseBytes = (rows + 1) * sizeof(size_t) + values.size() * (sizeof(T) + sizeof(uint32_t));
+
+		if (sparseBytes < denseBytes)
+		{
+			table.m_kind = StorageKind::Sparse;
+			table.m_rowOffsets = std::move(rowOffsets);
+			table.m_columns = std::move(columns);
+			table.m_values = std::move(values);
+
+			return table;
+		}
+
+		table.m_kind = StorageKind::Dense;
+		table.m_present.assign(rows * cols, 0);
+		table.m_values.resize(rows * cols);
+
+		for (size_t i = 0; i < rows; i++)
+		{
+			for (size_t k = rowOffsets[i]; k < rowOffsets[i + 1]; k++)
+			{
+				table.m_present[i * cols + columns[k]] = 1;
+				table.m_values[i * cols + columns[k]] = std::move(values[k]);
+			}
+		}
+
+		return table;
+	}
+
+	size_t Rows() const
+	{
+		return m_rows;
+	}
+
+	size_t Cols() const
+	{
+		return m_cols;
+	}
+
+	StorageKind Kind() const
+	{
+		return m_kind;
+	}
+
+	const T* Find(size_t row, size_t col) const
+	{
+		if (m_kind == StorageKind::Dense)
+		{
+			return m_present[row * m_cols + col] ? &m_values[row * m_cols + col] : nullptr;
+		}
+
+		for (size_t k = m_rowOffsets[row]; k < m_rowOffsets[row + 1]; k++)
+		{
+			if (m_columns[k] == col)
+			{
+				return &m_values[k];
+			}
+		}
+
+		return nullptr;
+	}
+
+	// Calls fn(row, col, value) for every present cell in row-major order
+	template <typename Fn>
+	void ForEach(Fn&& fn)
+	{
+		ForEachImpl(*this, 0, m_rows, fn);
+	}
+
+	template <typename Fn>
+	void ForEach(Fn&& fn) const
+	{
+		ForEachImpl(*this, 0, m_rows, fn);
+	}
+
+	// Same as ForEach for rows [first, last) only, so disjoint row ranges can be visited concurrently
+	template <typename Fn>
+	void ForEachInRows(size_t first, size_t last, Fn&& fn)
+	{
+		ForEachImpl(*this, first, last, fn);
+	}
+
+	// Calls fn(col, value) for every column of the row, value is nullptr for absent cells
+	template <typename Fn>
+	void VisitRow(size_t row, Fn&& fn) const
+	{
+		if (m_kind == StorageKind::Dense)
+		{
+			for (size_t j = 0; j < m_cols; j++)
+			{
+				fn(j, m_present[row * m_cols + j] ? &m_values[row * m_cols + j] : nullptr);
+			}
+
+			return;
+		}
+
+		size_t k = m_rowOffsets[row];
+
+		for (size_t j = 0; j < m_cols; j++)
+		{
+			if (k < m_rowOffsets[row + 1] && m_columns[k] == j)
+			{
+				fn(j, &m_values[k++]);
+			}
+			else
+			{
+				fn(j, static_cast<const T*>(nullptr));
+			}
+		}
+	}
+
+private:
+	template <typename Self, typename Fn>
+	static void ForEachImpl(Self& self, size_t first, size_t last, Fn& fn)
+	{
+		if (self.m_kind == StorageKind::Dense)
+		{
+			for (size_t i = first; i < last; i++)
+			{
+				for (size_t j = 0; j < self.m_cols; j++)
+				{
+					if (self.m_present[i * self.m_cols + j])
+					{
+						fn(i, j, self.m_values[i * self.m_cols + j]);
+					}
+				}
+			}
+
+			return;
+		}
+
+		for (size_t i = first; i < last; i++)
+		{
+			for (size_t k = self.m_rowOffsets[i]; k < self.m_rowOffsets[i + 1]; k++)
+			{
+				fn(i, static_cast<size_t>(self.m_columns[k]), self.m_values[k]);
+			}
+		}
+	}
+
+	StorageKind m_kind = StorageKind::Sparse;
+	size_t m_rows = 0;
+	size_t m_cols = 0;
+	std::vector<size_t> m_rowOffsets;
+	std::vector<uint32_t> m_columns;
+	std::vector<uint8_t> m_present;
+	std::vector<T> m_values;
+};
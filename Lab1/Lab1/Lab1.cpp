@@ -1,22 +1,91 @@
 ﻿#include "core.h"
+#include "../../Common/AllocationHooks.h"
+#include "../../Common/OutputBuffer.h"
+#include "../../Common/Stats.h"
 #include <iostream>
+#include <thread>
+
+using namespace MealyToMoore;
 
 int main(int argc, char* argv[])
 try
 {
-	if (argc != 2)
+	int threads{ 1 };
+	int initialState{ -1 };
+	std::string binaryOutput;
+
+	for (int i = 2; i < argc; i += 2)
 	{
-		std::cout << "Expected arguments: <input file>" << std::endl;
+		std::string option{ argv[i] };
+
+		if (option == "--stats")
+		{
+			Stats::Enable();
+			i--;
+			continue;
+		}
+
+		if (i + 1 == argc || (option != "--threads" && option != "--binary" && option != "--initial"))
+		{
+			argc = 0;
+			break;
+		}
+
+		if (option == "--threads")
+		{
+			threads = std::stoi(argv[i + 1]);
+			threads = threads > 0 ? threads : static_cast<int>(std::thread::hardware_concurrency());
+		}
+		else if (option == "--initial")
+		{
+			initialState = std::stoi(argv[i + 1]);
+		}
+		else
+		{
+			binaryOutput = argv[i + 1];
+		}
+	}
+
+	if (argc < 2)
+	{
+		std::cout << "Expected arguments: <input file> [--threads N] [--initial S] [--binary <output file>] [--stats]" << std::endl;
 		return 0;
 	}
 
 	MachineMatrix matrix{ ReadFile(std::string(argv[1])) };
-	TransitionSet transitions{ CreateTransitionSet(matrix) };
+	std::vector<bool> rows;
 
-	AddMooreStates(matrix, transitions);
-	WriteMooreMachineToStream(matrix, transitions);
+	if (initialState != -1)
+	{
+		if (initialState < 0 || static_cast<size_t>(initialState) >= matrix.Rows())
+		{
+			throw std::runtime_error("Initial state " + std::to_string(initialState) + " is out of range");
+		}
+
+		rows = FindReachableRows(matrix, initialState);
+	}
+
+	TransitionSet transitions{ AddMooreStates(matrix, threads, rows) };
+	Stats::Count("moore_states", static_cast<int64_t>(transitions.size()));
+
+	if (!binaryOutput.empty())
+	{
+		WriteMooreMachineToBinary(matrix, transitions, binaryOutput);
+	}
+	else
+	{
+		WriteMooreMachineToStream(matrix, transitions, std::cout, threads);
+	}
+
+	CheckOutput();
+
+	if (Stats::Enabled())
+	{
+		Stats::Write(std::cerr);
+	}
 }
 catch (const std::exception& e)
 {
 	std::cerr << e.what() << std::endl;
+	return 1;
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 #include <tuple>
 
+namespace MealyToMoore
+{
 struct Transition
 {
 	int state;
@@ -25,4 +27,5 @@ public:
 
 		return left.state < right.state;
 	}
-};
\ No newline at end of file
+};
+} // namespace MealyToMoore
\ No newline at end of file
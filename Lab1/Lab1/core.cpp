@@ -1,180 +1,735 @@
 #include "core.h"
-#include <sstream>
-
+#include "../../Common/BinaryMachine.h"
+#include "../../Common/MappedFile.h"
+#include "../../Common/OutputBuffer.h"
+#include "../../Common/Parallel.h"
+#include "../../Common/Stats.h"
+#include "../../Common/TextScanner.h"
+#include <array>
+#include <climits>
+#include <span>
+
+namespace MealyToMoore
+{
 namespace
 {
-MachineMatrix CreateMatrix(size_t rows, size_t cols);
-
-std::pair<size_t, size_t> ReadHeader(std::ifstream& file);
+struct PairRange
+{
+	int minState{ INT_MAX };
+	int maxState{ INT_MIN };
+	int minOutput{ INT_MAX };
+	int maxOutput{ INT_MIN };
+};
+
+// (state - minState, output - minOutput) packed into one key that orders like the pair
+template <typename Cell>
+struct PairEntry
+{
+	uint64_t key;
+	Cell cell;
+};
 
-MachineMatrix ReadMatrix(std::ifstream& file, size_t rows, size_t cols);
+// Cells of the matrix, every cell keeps its own Moore state
+class MatrixCells
+{
+public:
+	using Cell = Transition*;
 
-std::string GetActionToken(std::stringstream& sstream);
+	explicit MatrixCells(MachineMatrix& matrix)
+		: m_matrix(matrix)
+	{
+	}
 
-Transition GetStateOutputPair(const std::string& token);
-} // namespace
+	size_t Rows() const
+	{
+		return m_matrix.Rows();
+	}
 
-MachineMatrix ReadFile(const std::string& filename)
-{
-	std::ifstream file(filename);
+	template <typename Fn>
+	void ForEachInRows(size_t first, size_t last, Fn&& fn)
+	{
+		m_matrix.ForEachInRows(first, last, [&fn](size_t row, size_t, Transition& cell) {
+			fn(row, &cell);
+		});
+	}
 
-	if (!file.is_open())
+	static Transition Pair(Cell cell)
 	{
-		throw std::runtime_error("Unable to open file " + filename);
+		return *cell;
 	}
 
-	auto [k, m] = ReadHeader(file);
+	static void SetMooreState(Cell cell, int state)
+	{
+		cell->mooreState = state;
+	}
 
-	return ReadMatrix(file, k, m);
-}
+private:
+	MachineMatrix& m_matrix;
+};
 
-void AddMooreStates(MachineMatrix& matrix, const TransitionSet& transitions)
+// Cells of row-major target and output arrays read in place, the Moore states go to an array of their own
+class ArrayCells
 {
-	size_t rows{ matrix.size() };
-	size_t cols{ matrix[0].size() };
+public:
+	using Cell = size_t;
+
+	ArrayCells(size_t rows, size_t cols, std::span<const int32_t> targets, std::span<const int32_t> outputs,
+		std::vector<int32_t>& mooreStates)
+		: m_rows(rows)
+		, m_cols(cols)
+		, m_targets(targets)
+		, m_outputs(outputs)
+		, m_mooreStates(mooreStates)
+	{
+	}
 
-	int nextIndex{ 0 };
+	size_t Rows() const
+	{
+		return m_rows;
+	}
 
-	for (const auto& transition : transitions)
+	template <typename Fn>
+	void ForEachInRows(size_t first, size_t last, Fn&& fn)
 	{
-		for (size_t i = 0; i < rows; i++)
+		for (size_t row = first; row < last; row++)
 		{
-			for (size_t j = 0; j < cols; j++)
+			for (size_t cell = row * m_cols; cell < (row + 1) * m_cols; cell++)
 			{
-				if (matrix[i][j].has_value() && matrix[i][j] == transition)
+				if (m_targets[cell] != NoTransition)
 				{
-					matrix[i][j].value().mooreState = nextIndex;
+					fn(row, cell);
 				}
 			}
 		}
+	}
 
-		nextIndex++;
+	Transition Pair(Cell cell) const
+	{
+		return { m_targets[cell], m_outputs.empty() ? 0 : m_outputs[cell] };
 	}
+
+	void SetMooreState(Cell cell, int state)
+	{
+		m_mooreStates[cell] = state;
+	}
+
+private:
+	size_t m_rows;
+	size_t m_cols;
+	std::span<const int32_t> m_targets;
+	std::span<const int32_t> m_outputs;
+	std::vector<int32_t>& m_mooreStates;
+};
+
+void AddToRange(PairRange& range, const Transition& cell);
+
+uint64_t PairKey(const Transition& cell, const PairRange& range);
+
+Transition PairOfKey(uint64_t key, const PairRange& range);
+
+template <typename Cells>
+TransitionSet NumberPairs(Cells& cells, int threads, const std::vector<bool>& rows);
+
+template <typename Cell>
+void SortByKey(std::vector<PairEntry<Cell>>& entries, std::vector<PairEntry<Cell>>& buffer);
+
+template <typename Cells>
+TransitionSet NumberPairsDense(Cells& cells, const std::vector<typename Cells::Cell>& used, const PairRange& range);
+
+template <typename Cells>
+TransitionSet NumberPairsRadix(Cells& cells, const std::vector<typename Cells::Cell>& used, const PairRange& range);
+
+template <typename Cells>
+TransitionSet NumberPairsParallel(Cells& cells, int threads, const std::vector<bool>& rows);
+
+MachineMatrix CreateMatrix(size_t rows, size_t cols, std::span<const int32_t> targets, std::span<const int32_t> outputs);
+
+Automaton CreateMooreMachine(const MachineMatrix& matrix, const TransitionSet& transitions);
+
+std::pair<size_t, size_t> ReadHeader(TextScanner& scanner);
+
+MachineMatrix ReadMatrix(TextScanner& scanner, size_t rows, size_t cols);
+
+MachineMatrix ReadBinaryMatrix(const BinaryMachine& machine);
+
+Transition ReadStateOutputPair(TextScanner& scanner, size_t rows);
+} // namespace
+
+MachineMatrix ReadFile(const std::string& filename)
+{
+	ScopedTimer timer{ "parse" };
+
+	auto file = std::make_shared<MappedFile>(filename);
+
+	if (IsBinaryMachine(file->Data()))
+	{
+		return ReadBinaryMatrix(BinaryMachine(file));
+	}
+
+	TextScanner scanner(file->Data());
+
+	auto [k, m] = ReadHeader(scanner);
+
+	return ReadMatrix(scanner, k, m);
+}
+
+TransitionSet AddMooreStates(MachineMatrix& matrix, int threads, const std::vector<bool>& rows)
+{
+	ScopedTimer timer{ "add_moore_states" };
+
+	MatrixCells cells{ matrix };
+
+	return NumberPairs(cells, threads, rows);
 }
 
-TransitionSet CreateTransitionSet(const MachineMatrix& matrix)
+// The Moore states are numbered into an array beside the Mealy arrays, which are released
+// before the Moore machine is built
+Automaton ConvertToMoore(Automaton mealy, int threads)
 {
-	std::set<Transition, TransitionLessComparator> transitions;
+	size_t cols{ mealy.inputs };
+	std::vector<int32_t> mooreStates(mealy.states * cols, NoTransition);
+	TransitionSet transitions;
 
-	for (const auto& vec : matrix)
 	{
-		for (const auto& transition : vec)
+		ScopedTimer timer{ "add_moore_states" };
+
+		ArrayCells cells{ mealy.states, cols, mealy.transitions.View(), mealy.outputs.View(), mooreStates };
+		transitions = NumberPairs(cells, threads, {});
+	}
+
+	mealy = Automaton();
+
+	// Moore state i is pair i, its row is the row of Moore states of the pair's Mealy state
+	std::vector<int32_t> outputs(transitions.size());
+	std::vector<int32_t> targets(transitions.size() * cols);
+
+	ParallelFor(threads, transitions.size(), [&](size_t begin, size_t end) {
+		for (size_t state = begin; state < end; state++)
 		{
-			if (transition.has_value())
+			outputs[state] = transitions[state].output;
+			std::copy_n(mooreStates.begin() + transitions[state].state * cols, cols, targets.begin() + state * cols);
+		}
+	});
+
+	Automaton moore;
+	moore.kind = MachineKind::Moore;
+	moore.states = transitions.size();
+	moore.inputs = cols;
+	moore.transitions = MachineArray<int32_t>(std::move(targets));
+	moore.outputs = MachineArray<int32_t>(std::move(outputs));
+
+	return moore;
+}
+
+// Breadth-first search over the Mealy states, which is the same as a search over the
+// (state, output) pairs because the successors of a pair only depend on its state
+std::vector<bool> FindReachableRows(const MachineMatrix& matrix, int initialState)
+{
+	std::vector<bool> reachable(matrix.Rows(), false);
+	std::vector<int> queue{ initialState };
+
+	reachable[initialState] = true;
+
+	for (size_t next = 0; next < queue.size(); next++)
+	{
+		matrix.VisitRow(queue[next], [&matrix, &reachable, &queue](size_t, const Transition* cell) {
+			if (cell == nullptr)
 			{
-				transitions.insert(transition.value());
+				return;
 			}
-		}
+
+			if (cell->state < 0 || static_cast<size_t>(cell->state) >= matrix.Rows())
+			{
+				throw std::runtime_error("State " + std::to_string(cell->state) + " is out of range");
+			}
+
+			if (!reachable[cell->state])
+			{
+				reachable[cell->state] = true;
+				queue.push_back(cell->state);
+			}
+		});
 	}
 
-	return transitions;
+	return reachable;
 }
 
 void WriteMooreMachineToStream(
 	const MachineMatrix& matrix,
 	const TransitionSet& transitions,
-	std::ostream& stream)
+	std::ostream& stream,
+	int threads)
 {
-	size_t cols{ matrix[0].size() };
+	ScopedTimer timer{ "write" };
 
-	for (const auto& transition : transitions)
-	{
-		stream << "Y" << transition.output << " ";
+	WriteRowsParallel(stream, transitions.size(), threads, [&matrix, &transitions](size_t i, OutputBuffer& out) {
+		const Transition& transition{ transitions[i] };
+		out << "Y" << transition.output << " ";
 
-		for (size_t j = 0; j < cols; j++)
-		{
-			if (matrix[transition.state][j].has_value()
-				&& matrix[transition.state][j].value().mooreState != -1)
+		matrix.VisitRow(transition.state, [&out](size_t, const Transition* cell) {
+			if (cell != nullptr && cell->mooreState != -1)
 			{
-				stream << "q" << matrix[transition.state][j].value().mooreState << " ";
+				out << "q" << cell->mooreState << " ";
 			}
 			else
 			{
-				stream << "- ";
+				out << "- ";
 			}
+		});
+
+		out << '\n';
+	});
+}
+
+void WriteMooreMachineToBinary(
+	const MachineMatrix& matrix,
+	const TransitionSet& transitions,
+	const std::string& filename)
+{
+	ScopedTimer timer{ "write" };
+
+	WriteBinaryMachine(filename, CreateMooreMachine(matrix, transitions));
+}
+
+namespace
+{
+// Linear in the number of cells. A pair is numbered by its rank in (state, output) order,
+// ranks come from a dense state x output table when it is not much larger than the matrix
+// and from a radix sort of the pairs otherwise.
+template <typename Cells>
+TransitionSet NumberPairs(Cells& cells, int threads, const std::vector<bool>& rows)
+{
+	if (threads > 1)
+	{
+		return NumberPairsParallel(cells, threads, rows);
+	}
+
+	std::vector<typename Cells::Cell> used;
+	PairRange range;
+
+	cells.ForEachInRows(0, cells.Rows(), [&cells, &used, &range, &rows](size_t row, typename Cells::Cell cell) {
+		if (rows.empty() || rows[row])
+		{
+			used.push_back(cell);
+			AddToRange(range, cells.Pair(cell));
 		}
+	});
 
-		stream << std::endl;
+	if (used.empty())
+	{
+		return {};
 	}
+
+	uint64_t states{ static_cast<uint64_t>(static_cast<int64_t>(range.maxState) - range.minState) + 1 };
+	uint64_t outputs{ static_cast<uint64_t>(static_cast<int64_t>(range.maxOutput) - range.minOutput) + 1 };
+
+	if (states * outputs <= 4 * used.size() + 4096)
+	{
+		return NumberPairsDense(cells, used, range);
+	}
+
+	return NumberPairsRadix(cells, used, range);
 }
 
-namespace
+template <typename Cells>
+TransitionSet NumberPairsDense(Cells& cells, const std::vector<typename Cells::Cell>& used, const PairRange& range)
 {
-std::pair<size_t, size_t> ReadHeader(std::ifstream& file)
+	const int absent{ -1 };
+	const int present{ -2 };
+	size_t outputs{ static_cast<size_t>(static_cast<int64_t>(range.maxOutput) - range.minOutput) + 1 };
+	size_t states{ static_cast<size_t>(static_cast<int64_t>(range.maxState) - range.minState) + 1 };
+
+	auto slot = [&range, outputs](const Transition& cell) {
+		return static_cast<size_t>(static_cast<int64_t>(cell.state) - range.minState) * outputs
+			+ static_cast<size_t>(static_cast<int64_t>(cell.output) - range.minOutput);
+	};
+
+	std::vector<int> ids(states * outputs, absent);
+
+	for (typename Cells::Cell cell : used)
+	{
+		ids[slot(cells.Pair(cell))] = present;
+	}
+
+	TransitionSet transitions;
+
+	for (size_t i = 0; i < ids.size(); i++)
+	{
+		if (ids[i] == present)
+		{
+			ids[i] = static_cast<int>(transitions.size());
+			transitions.push_back({ static_cast<int>(range.minState + static_cast<int64_t>(i / outputs)),
+				static_cast<int>(range.minOutput + static_cast<int64_t>(i % outputs)) });
+		}
+	}
+
+	for (typename Cells::Cell cell : used)
+	{
+		cells.SetMooreState(cell, ids[slot(cells.Pair(cell))]);
+	}
+
+	return transitions;
+}
+
+void AddToRange(PairRange& range, const Transition& cell)
 {
-	size_t k{}, m{};
+	range.minState = std::min(range.minState, cell.state);
+	range.maxState = std::max(range.maxState, cell.state);
+	range.minOutput = std::min(range.minOutput, cell.output);
+	range.maxOutput = std::max(range.maxOutput, cell.output);
+}
 
-	file >> k >> m;
-	file.get();
+uint64_t PairKey(const Transition& cell, const PairRange& range)
+{
+	uint64_t state{ static_cast<uint64_t>(static_cast<int64_t>(cell.state) - range.minState) };
+	uint64_t output{ static_cast<uint64_t>(static_cast<int64_t>(cell.output) - range.minOutput) };
 
-	return std::pair(k, m);
+	return state << 32 | output;
 }
 
-MachineMatrix ReadMatrix(std::ifstream& file, size_t rows, size_t cols)
+Transition PairOfKey(uint64_t key, const PairRange& range)
 {
-	MachineMatrix matrix{ CreateMatrix(rows, cols) };
+	return { static_cast<int>(range.minState + static_cast<int64_t>(key >> 32)),
+		static_cast<int>(range.minOutput + static_cast<int64_t>(key & 0xFFFFFFFF)) };
+}
 
-	std::stringstream ss;
-	std::string line;
-	std::string token;
+// LSD radix sort by bytes of the keys, bytes that are zero in every key are skipped
+template <typename Cell>
+void SortByKey(std::vector<PairEntry<Cell>>& entries, std::vector<PairEntry<Cell>>& buffer)
+{
+	uint64_t maxKey{ 0 };
 
-	for (int i = 0; i < rows; i++)
+	for (const PairEntry<Cell>& entry : entries)
 	{
-		std::getline(file, line);
-		ss.str(line);
+		maxKey = std::max(maxKey, entry.key);
+	}
+
+	buffer.resize(entries.size());
 
+	for (int shift = 0; shift < 64 && (maxKey >> shift) != 0; shift += 8)
+	{
+		std::array<size_t, 257> counts{};
+
+		for (const PairEntry<Cell>& entry : entries)
+		{
+			counts[((entry.key >> shift) & 0xFF) + 1]++;
+		}
+
+		for (size_t i = 1; i < counts.size(); i++)
+		{
+			counts[i] += counts[i - 1];
+		}
+
+		for (const PairEntry<Cell>& entry : entries)
+		{
+			buffer[counts[(entry.key >> shift) & 0xFF]++] = entry;
+		}
+
+		entries.swap(buffer);
+	}
+}
+
+template <typename Cells>
+TransitionSet NumberPairsRadix(Cells& cells, const std::vector<typename Cells::Cell>& used, const PairRange& range)
+{
+	std::vector<PairEntry<typename Cells::Cell>> entries;
+	std::vector<PairEntry<typename Cells::Cell>> buffer;
+
+	entries.reserve(used.size());
+
+	for (typename Cells::Cell cell : used)
+	{
+		entries.push_back({ PairKey(cells.Pair(cell), range), cell });
+	}
+
+	SortByKey(entries, buffer);
+
+	TransitionSet transitions;
+
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		if (i == 0 || entries[i].key != entries[i - 1].key)
+		{
+			transitions.push_back(PairOfKey(entries[i].key, range));
+		}
+
+		cells.SetMooreState(entries[i].cell, static_cast<int>(transitions.size()) - 1);
+	}
+
+	return transitions;
+}
+
+// Every shard of rows sorts its own pairs, the distinct keys of all shards are merged
+// with a parallel sort and deduplicated with a prefix sum over per-chunk counts.
+// Ranks in the merged keys are the same numbers the serial path assigns.
+template <typename Cells>
+TransitionSet NumberPairsParallel(Cells& cells, int threads, const std::vector<bool>& rows)
+{
+	using Entry = PairEntry<typename Cells::Cell>;
+
+	size_t shards{ static_cast<size_t>(threads) };
+	std::vector<std::vector<Entry>> entries(shards);
+	std::vector<std::vector<uint64_t>> shardKeys(shards);
+	std::vector<PairRange> ranges(shards);
+
+	ParallelFor(threads, shards, [&](size_t begin, size_t end) {
+		for (size_t shard = begin; shard < end; shard++)
+		{
+			size_t first{ cells.Rows() * shard / shards };
+			size_t last{ cells.Rows() * (shard + 1) / shards };
+
+			cells.ForEachInRows(first, last, [&cells, &entries, &ranges, &rows, shard](size_t row, typename Cells::Cell cell) {
+				if (rows.empty() || rows[row])
+				{
+					entries[shard].push_back({ 0, cell });
+					AddToRange(ranges[shard], cells.Pair(cell));
+				}
+			});
+		}
+	});
+
+	PairRange range;
+
+	for (const PairRange& shardRange : ranges)
+	{
+		range.minState = std::min(range.minState, shardRange.minState);
+		range.maxState = std::max(range.maxState, shardRange.maxState);
+		range.minOutput = std::min(range.minOutput, shardRange.minOutput);
+		range.maxOutput = std::max(range.maxOutput, shardRange.maxOutput);
+	}
+
+	ParallelFor(threads, shards, [&](size_t begin, size_t end) {
+		std::vector<Entry> buffer;
+
+		for (size_t shard = begin; shard < end; shard++)
+		{
+			for (Entry& entry : entries[shard])
+			{
+				entry.key = PairKey(cells.Pair(entry.cell), range);
+			}
+
+			SortByKey(entries[shard], buffer);
+
+			for (size_t i = 0; i < entries[shard].size(); i++)
+			{
+				if (i == 0 || entries[shard][i].key != entries[shard][i - 1].key)
+				{
+					shardKeys[shard].push_back(entries[shard][i].key);
+				}
+			}
+		}
+	});
+
+	std::vector<size_t> offsets(shards + 1, 0);
+
+	for (size_t shard = 0; shard < shards; shard++)
+	{
+		offsets[shard + 1] = offsets[shard] + shardKeys[shard].size();
+	}
+
+	std::vector<uint64_t> keys(offsets[shards]);
+	std::vector<uint64_t> buffer;
+	std::vector<size_t> bounds;
+
+	ParallelFor(threads, shards, [&](size_t begin, size_t end) {
+		for (size_t shard = begin; shard < end; shard++)
+		{
+			std::ranges::copy(shardKeys[shard], keys.begin() + offsets[shard]);
+		}
+	});
+
+	ParallelSort(keys, buffer, bounds, threads, std::less<uint64_t>());
+
+	// Keys that differ from their predecessor are counted per chunk, the exclusive
+	// prefix sum of the counts tells every chunk where its distinct keys go
+	size_t chunks{ std::min(shards, std::max<size_t>(keys.size(), 1)) };
+	std::vector<size_t> firstIndex(chunks + 1, 0);
+	auto isFirst = [&keys](size_t i) {
+		return i == 0 || keys[i] != keys[i - 1];
+	};
+
+	ParallelFor(threads, chunks, [&](size_t begin, size_t end) {
+		for (size_t chunk = begin; chunk < end; chunk++)
+		{
+			for (size_t i = keys.size() * chunk / chunks; i < keys.size() * (chunk + 1) / chunks; i++)
+			{
+				firstIndex[chunk + 1] += isFirst(i) ? 1 : 0;
+			}
+		}
+	});
+
+	for (size_t chunk = 0; chunk < chunks; chunk++)
+	{
+		firstIndex[chunk + 1] += firstIndex[chunk];
+	}
+
+	std::vector<uint64_t> distinct(firstIndex[chunks]);
+	TransitionSet transitions(distinct.size());
+
+	ParallelFor(threads, chunks, [&](size_t begin, size_t end) {
+		for (size_t chunk = begin; chunk < end; chunk++)
+		{
+			size_t next{ firstIndex[chunk] };
+
+			for (size_t i = keys.size() * chunk / chunks; i < keys.size() * (chunk + 1) / chunks; i++)
+			{
+				if (isFirst(i))
+				{
+					transitions[next] = PairOfKey(keys[i], range);
+					distinct[next++] = keys[i];
+				}
+			}
+		}
+	});
+
+	ParallelFor(threads, shards, [&](size_t begin, size_t end) {
+		for (size_t shard = begin; shard < end; shard++)
+		{
+			auto position = distinct.begin();
+
+			for (size_t i = 0; i < entries[shard].size(); i++)
+			{
+				if (i == 0 || entries[shard][i].key != entries[shard][i - 1].key)
+				{
+					position = std::lower_bound(position, distinct.end(), entries[shard][i].key);
+				}
+
+				cells.SetMooreState(entries[shard][i].cell, static_cast<int>(position - distinct.begin()));
+			}
+		}
+	});
+
+	return transitions;
+}
+
+MachineMatrix CreateMatrix(size_t rows, size_t cols, std::span<const int32_t> targets, std::span<const int32_t> outputs)
+{
+	std::vector<size_t> rowOffsets{ 0 };
+	std::vector<uint32_t> columns;
+	std::vector<Transition> values;
+
+	rowOffsets.reserve(rows + 1);
+
+	for (size_t i = 0; i < rows; i++)
+	{
 		for (size_t j = 0; j < cols; j++)
 		{
-			token = GetActionToken(ss);
-			if (token != "-")
+			if (targets[i * cols + j] != NoTransition)
 			{
-				matrix[i][j] = GetStateOutputPair(token);
+				columns.push_back(static_cast<uint32_t>(j));
+				values.push_back({ targets[i * cols + j], outputs[i * cols + j] });
 			}
 		}
 
-		ss.clear();
-		file >> std::ws;
+		rowOffsets.push_back(values.size());
+	}
+
+	return MachineMatrix::FromRows(rows, cols, std::move(rowOffsets), std::move(columns), std::move(values));
+}
+
+Automaton CreateMooreMachine(const MachineMatrix& matrix, const TransitionSet& transitions)
+{
+	std::vector<int32_t> outputs;
+	std::vector<int32_t> targets(transitions.size() * matrix.Cols(), NoTransition);
+	size_t state{ 0 };
+
+	outputs.reserve(transitions.size());
+
+	for (const auto& transition : transitions)
+	{
+		outputs.push_back(transition.output);
+
+		matrix.VisitRow(transition.state, [&targets, &matrix, state](size_t col, const Transition* cell) {
+			if (cell != nullptr && cell->mooreState != -1)
+			{
+				targets[state * matrix.Cols() + col] = cell->mooreState;
+			}
+		});
+
+		state++;
 	}
 
-	return matrix;
+	Automaton moore;
+	moore.kind = MachineKind::Moore;
+	moore.states = transitions.size();
+	moore.inputs = matrix.Cols();
+	moore.transitions = MachineArray<int32_t>(std::move(targets));
+	moore.outputs = MachineArray<int32_t>(std::move(outputs));
+
+	return moore;
 }
 
-MachineMatrix CreateMatrix(size_t rows, size_t cols)
+std::pair<size_t, size_t> ReadHeader(TextScanner& scanner)
 {
-	MachineMatrix matrix;
+	scanner.SkipWhitespace();
+	size_t k{ scanner.ReadNumber<size_t>() };
+	scanner.SkipSpaces();
+	size_t m{ scanner.ReadNumber<size_t>() };
+	scanner.ExpectLineEnd();
 
-	matrix.reserve(rows);
-	matrix.resize(rows);
+	return std::pair(k, m);
+}
+
+MachineMatrix ReadMatrix(TextScanner& scanner, size_t rows, size_t cols)
+{
+	std::vector<size_t> rowOffsets{ 0 };
+	std::vector<uint32_t> columns;
+	std::vector<Transition> values;
 
-	for (auto& cell : matrix)
+	rowOffsets.reserve(rows + 1);
+
+	for (size_t i = 0; i < rows; i++)
 	{
-		cell.reserve(cols);
-		cell.resize(cols);
+		scanner.SkipWhitespace();
+
+		for (size_t j = 0; j < cols; j++)
+		{
+			if (j != 0)
+			{
+				scanner.SkipSpaces();
+				scanner.Expect(',');
+				scanner.SkipSpaces();
+			}
+
+			if (scanner.Peek() == '-')
+			{
+				scanner.Advance();
+				continue;
+			}
+
+			columns.push_back(static_cast<uint32_t>(j));
+			values.push_back(ReadStateOutputPair(scanner, rows));
+		}
+
+		rowOffsets.push_back(values.size());
+		scanner.ExpectLineEnd();
 	}
 
-	return matrix;
+	return MachineMatrix::FromRows(rows, cols, std::move(rowOffsets), std::move(columns), std::move(values));
 }
 
-std::string GetActionToken(std::stringstream& sstream)
+MachineMatrix ReadBinaryMatrix(const BinaryMachine& machine)
 {
-	std::string token;
-	std::getline(sstream, token, ',');
-	sstream >> std::ws;
+	machine.Expect(MachineKind::Mealy);
 
-	return token;
+	return CreateMatrix(machine.Header().states, machine.Header().inputs, machine.Transitions(), machine.Outputs());
 }
 
-Transition GetStateOutputPair(const std::string& token)
+Transition ReadStateOutputPair(TextScanner& scanner, size_t rows)
 {
-	std::stringstream ss(token);
-	int s{}, y{};
+	scanner.Expect('S');
+	int s{ scanner.ReadNumber<int>() };
 
-	ss.get();
-	ss >> s;
-	ss >> std::ws;
-	ss.get();
-	ss >> y;
+	if (s < 0 || static_cast<size_t>(s) >= rows)
+	{
+		scanner.Fail("state " + std::to_string(s) + " is out of range");
+	}
+
+	scanner.SkipSpaces();
+	scanner.Expect('Y');
+	int y{ scanner.ReadNumber<int>() };
 
 	return { s, y };
 }
-} // namespace
\ No newline at end of file
+} // namespace
+} // namespace MealyToMoore
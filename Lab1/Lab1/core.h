@@ -1,22 +1,43 @@
 #pragma once
+#include "../../Common/Automaton.h"
+#include "../../Common/TransitionTable.h"
 #include "Transition.h"
 #include <fstream>
 #include <iostream>
-#include <optional>
-#include <set>
 #include <string>
 #include <vector>
 
-using MachineMatrix = std::vector<std::vector<std::optional<Transition>>>;
-using TransitionSet = std::set<Transition, TransitionLessComparator>;
+// Mealy to Moore conversion, shared by Lab1, the pipeline and the benchmark
+namespace MealyToMoore
+{
+using MachineMatrix = TransitionTable<Transition>;
+// Distinct (state, output) pairs in TransitionLessComparator order, the index of a pair is its Moore state
+using TransitionSet = std::vector<Transition>;
 
 MachineMatrix ReadFile(const std::string& filename);
 
-TransitionSet CreateTransitionSet(const MachineMatrix& matrix);
+// Collects the distinct pairs of the cells and stores the Moore state of its pair in every cell.
+// Only cells of the rows marked in rows are used unless it is empty, other cells keep no Moore state.
+// The numbering does not depend on the number of threads.
+TransitionSet AddMooreStates(MachineMatrix& matrix, int threads = 1, const std::vector<bool>& rows = {});
 
-void AddMooreStates(MachineMatrix& matrix, const TransitionSet& transitions);
+// Marks the Mealy states reachable from the initial one, pairs found in their rows are
+// exactly the Moore states reachable after the first input
+std::vector<bool> FindReachableRows(const MachineMatrix& matrix, int initialState);
+
+// Moore machine of a Mealy one in memory, numbered like AddMooreStates does. The arrays are read
+// in place, the Moore state of every cell is the only thing kept besides them.
+// Without outputs, as for a DFA, every transition outputs 0.
+Automaton ConvertToMoore(Automaton mealy, int threads = 1);
 
 void WriteMooreMachineToStream(
 	const MachineMatrix& matrix,
 	const TransitionSet& transitions,
-	std::ostream& stream = std::cout);
\ No newline at end of file
+	std::ostream& stream = std::cout,
+	int threads = 1);
+
+void WriteMooreMachineToBinary(
+	const MachineMatrix& matrix,
+	const TransitionSet& transitions,
+	const std::string& filename);
+} // namespace MealyToMoore
\ No newline at end of file
@@ -1,18 +1,60 @@
 ﻿#include "core.h"
+#include "../../Common/AllocationHooks.h"
+#include "../../Common/OutputBuffer.h"
+#include "../../Common/Stats.h"
 #include <iostream>
 
+using namespace MooreToMealy;
+
 int main(int argc, char* argv[])
 try
 {
-	if (argc != 2)
+	std::string binaryOutput;
+
+	for (int i = 2; i < argc; i += 2)
+	{
+		std::string option{ argv[i] };
+
+		if (option == "--stats")
+		{
+			Stats::Enable();
+			i--;
+		}
+		else if (i + 1 < argc && option == "--binary")
+		{
+			binaryOutput = argv[i + 1];
+		}
+		else
+		{
+			argc = 0;
+			break;
+		}
+	}
+
+	if (argc < 2)
+	{
+		std::cout << "Expected arguments: <input file> [--binary <output file>] [--stats]" << std::endl;
+		return 0;
+	}
+
+	if (!binaryOutput.empty())
+	{
+		WriteMealyMachineToBinary(ReadFile(argv[1]), binaryOutput);
+	}
+	else
 	{
-		std::cout << "Expected arguments: <input file>" << std::endl;
+		ConvertToMealyStream(argv[1]);
 	}
 
-	MachineMatrix matrix{ ReadFile(argv[1]) };
-	WriteMealyMachineToStream(matrix);
+	CheckOutput();
+
+	if (Stats::Enabled())
+	{
+		Stats::Write(std::cerr);
+	}
 }
 catch (const std::exception& e)
 {
 	std::cerr << e.what() << std::endl;
+	return 1;
 }
\ No newline at end of file
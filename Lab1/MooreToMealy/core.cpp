@@ -1,132 +1,288 @@
 #include "core.h"
+#include "../../Common/BinaryMachine.h"
+#include "../../Common/MappedFile.h"
+#include "../../Common/OutputBuffer.h"
+#include "../../Common/Parallel.h"
+#include "../../Common/Stats.h"
+#include "../../Common/TextScanner.h"
 
+namespace MooreToMealy
+{
 namespace
 {
-std::pair<size_t, size_t> ReadHeader(std::ifstream& file);
+MachineMatrix ReadMatrix(TextScanner& scanner);
 
-MachineMatrix CreateMatrix(size_t rows, size_t cols);
+MachineMatrix ReadBinaryMatrix(const BinaryMachine& machine);
 
-MachineMatrix ReadMatrix(std::ifstream& file, size_t rows, size_t cols);
+void MapOutputsToStatesInTransitions(MachineMatrix& matrix, const std::vector<int>& outputs);
 
-void MapOutputsToStatesInTransitions(MachineMatrix& matrix, std::map<int, int>& outputs);
+void WriteMealyCell(OutputBuffer& out, int state, int output);
 }
 
 MachineMatrix ReadFile(const std::string& filename)
 {
-	std::ifstream file(filename);
+	ScopedTimer timer{ "parse" };
+
+	auto file{ std::make_shared<MappedFile>(filename) };
 
-	if (!file.is_open())
+	if (IsBinaryMachine(file->Data()))
 	{
-		throw std::runtime_error("Unable to open file " + filename);
+		return ReadBinaryMatrix(BinaryMachine(file));
 	}
 
-	auto [rows, cols] = ReadHeader(file);
+	TextScanner scanner(file->Data());
 
-	return ReadMatrix(file, rows, cols);
+	return ReadMatrix(scanner);
 }
 
-void WriteMealyMachineToStream(const MachineMatrix& matrix, std::ostream& stream)
+void ConvertToMealyStream(const std::string& filename, std::ostream& stream)
 {
-	size_t rows{ matrix.size() };
-	size_t cols{ matrix[0].size() };
+	ScopedTimer timer{ "convert" };
+
+	auto file{ std::make_shared<MappedFile>(filename) };
+	OutputBuffer out(stream);
+
+	if (IsBinaryMachine(file->Data()))
+	{
+		BinaryMachine machine(file);
+		machine.Expect(MachineKind::Moore);
+
+		size_t rows{ machine.Header().states };
+		size_t cols{ machine.Header().inputs };
+		std::span<const int32_t> targets{ machine.Transitions() };
+		std::span<const int32_t> outputs{ machine.Outputs() };
+
+		for (size_t i = 0; i < rows; i++)
+		{
+			for (size_t j = 0; j < cols; j++)
+			{
+				int state{ targets[i * cols + j] };
+				WriteMealyCell(out, state, state != NoTransition ? outputs[state] : 0);
+			}
+
+			out << '\n';
+		}
+
+		return;
+	}
+
+	TextScanner scanner(file->Data());
+
+	scanner.SkipWhitespace();
+	size_t rows{ scanner.ReadNumber<size_t>() };
+	scanner.SkipSpaces();
+	size_t cols{ scanner.ReadNumber<size_t>() };
+	scanner.ExpectLineEnd();
+
+	TextScanner firstRow{ scanner };
+	std::vector<int> outputs;
+	outputs.reserve(rows);
+
+	for (size_t i = 0; i < rows; i++)
+	{
+		scanner.SkipWhitespace();
+		scanner.Expect('Y');
+		outputs.push_back(scanner.ReadNumber<int>());
+		scanner.SkipLine();
+	}
+
+	scanner = firstRow;
 
 	for (size_t i = 0; i < rows; i++)
 	{
+		scanner.SkipWhitespace();
+		scanner.Expect('Y');
+		scanner.ReadNumber<int>();
+
 		for (size_t j = 0; j < cols; j++)
 		{
-			if (matrix[i][j].has_value())
+			scanner.SkipSpaces();
+
+			if (scanner.SkipStandalone('-'))
 			{
-				const Transition& t = matrix[i][j].value();
-				stream << std::format("S{} Y{} ", t.state, t.output);
+				WriteMealyCell(out, NoTransition, 0);
+				continue;
 			}
-			else
+
+			scanner.Expect('q');
+			int state{ scanner.ReadNumber<int>() };
+
+			if (state < 0 || static_cast<size_t>(state) >= rows)
 			{
-				stream << "- ";
+				scanner.Fail("state " + std::to_string(state) + " is out of range");
 			}
+
+			WriteMealyCell(out, state, outputs[state]);
 		}
 
-		stream << std::endl;
+		scanner.ExpectLineEnd();
+		out << '\n';
 	}
 }
 
-namespace
+Automaton ConvertToMealy(Automaton moore, int threads)
 {
-std::pair<size_t, size_t> ReadHeader(std::ifstream& file)
+	ScopedTimer timer{ "convert" };
+
+	std::span<const int32_t> targets{ moore.transitions.View() };
+	std::span<const int32_t> stateOutputs{ moore.outputs.View() };
+	std::vector<int32_t> outputs(moore.states * moore.inputs, -1);
+
+	ParallelFor(threads, outputs.size(), [&targets, &stateOutputs, &outputs](size_t begin, size_t end) {
+		for (size_t cell = begin; cell < end; cell++)
+		{
+			if (int state{ targets[cell] }; state != NoTransition)
+			{
+				outputs[cell] = stateOutputs[state];
+			}
+		}
+	});
+
+	Automaton mealy;
+	mealy.kind = MachineKind::Mealy;
+	mealy.states = moore.states;
+	mealy.inputs = moore.inputs;
+	mealy.transitions = std::move(moore.transitions);
+	mealy.outputs = MachineArray<int32_t>(std::move(outputs));
+
+	return mealy;
+}
+
+void WriteMealyMachineToStream(const MachineMatrix& matrix, std::ostream& stream)
 {
-	size_t k{}, m{};
+	ScopedTimer timer{ "write" };
 
-	file >> k >> m;
-	file.get();
+	WriteRowsParallel(stream, matrix.Rows(), 1, [&matrix](size_t i, OutputBuffer& out) {
+		matrix.VisitRow(i, [&out](size_t, const Transition* t) {
+			WriteMealyCell(out, t != nullptr ? t->state : NoTransition, t != nullptr ? t->output : 0);
+		});
 
-	return std::pair(k, m);
+		out << '\n';
+	});
 }
 
-MachineMatrix ReadMatrix(std::ifstream& file, size_t rows, size_t cols)
+void WriteMealyMachineToBinary(const MachineMatrix& matrix, const std::string& filename)
 {
-	MachineMatrix matrix{ CreateMatrix(rows, cols) };
-	std::map<int, int> outputs;
+	ScopedTimer timer{ "write" };
+
+	std::vector<int32_t> targets(matrix.Rows() * matrix.Cols(), NoTransition);
+	std::vector<int32_t> outputs(matrix.Rows() * matrix.Cols(), -1);
+
+	matrix.ForEach([&targets, &outputs, &matrix](size_t row, size_t col, const Transition& transition) {
+		targets[row * matrix.Cols() + col] = transition.state;
+		outputs[row * matrix.Cols() + col] = transition.output;
+	});
 
-	int state{};
-	int output{};
+	WriteBinaryMachine(filename, MachineKind::Mealy, matrix.Rows(), matrix.Cols(), targets, outputs);
+}
+
+namespace
+{
+// Same syntax and checks as ConvertToMealyStream, "Y1 q2 - q0"
+MachineMatrix ReadMatrix(TextScanner& scanner)
+{
+	scanner.SkipWhitespace();
+	size_t rows{ scanner.ReadNumber<size_t>() };
+	scanner.SkipSpaces();
+	size_t cols{ scanner.ReadNumber<size_t>() };
+	scanner.ExpectLineEnd();
+
+	std::vector<size_t> rowOffsets{ 0 };
+	std::vector<uint32_t> columns;
+	std::vector<Transition> values;
+	std::vector<int> outputs;
+
+	rowOffsets.reserve(rows + 1);
+	outputs.reserve(rows);
 
 	for (size_t i = 0; i < rows; i++)
 	{
-		file.get();
-		file >> output;
-		file >> std::ws;
-
-		outputs[static_cast<int>(i)] = output;
+		scanner.SkipWhitespace();
+		scanner.Expect('Y');
+		outputs.push_back(scanner.ReadNumber<int>());
 
 		for (size_t j = 0; j < cols; j++)
 		{
-			if (file.get() == '-')
+			scanner.SkipSpaces();
+
+			if (scanner.SkipStandalone('-'))
 			{
-				file >> std::ws;
 				continue;
 			}
 
-			file >> state;
-			file >> std::ws;
+			scanner.Expect('q');
+			int state{ scanner.ReadNumber<int>() };
 
-			matrix[i][j] = Transition{ state, -1 };
+			if (state < 0 || static_cast<size_t>(state) >= rows)
+			{
+				scanner.Fail("state " + std::to_string(state) + " is out of range");
+			}
+
+			columns.push_back(static_cast<uint32_t>(j));
+			values.push_back(Transition{ state, -1 });
 		}
+
+		scanner.ExpectLineEnd();
+		rowOffsets.push_back(values.size());
 	}
 
+	MachineMatrix matrix{ MachineMatrix::FromRows(rows, cols, std::move(rowOffsets), std::move(columns), std::move(values)) };
 	MapOutputsToStatesInTransitions(matrix, outputs);
 
 	return matrix;
 }
 
-MachineMatrix CreateMatrix(size_t rows, size_t cols)
+MachineMatrix ReadBinaryMatrix(const BinaryMachine& machine)
 {
-	MachineMatrix matrix;
+	machine.Expect(MachineKind::Moore);
 
-	matrix.reserve(rows);
-	matrix.resize(rows);
+	size_t rows{ machine.Header().states };
+	size_t cols{ machine.Header().inputs };
+	std::span<const int32_t> targets{ machine.Transitions() };
+	std::span<const int32_t> outputs{ machine.Outputs() };
 
-	for (auto& cell : matrix)
-	{
-		cell.reserve(cols);
-		cell.resize(cols);
-	}
+	std::vector<size_t> rowOffsets{ 0 };
+	std::vector<uint32_t> columns;
+	std::vector<Transition> values;
 
-	return matrix;
-}
-
-void MapOutputsToStatesInTransitions(MachineMatrix& matrix, std::map<int, int>& outputs)
-{
-	size_t rows{ matrix.size() };
-	size_t cols{ matrix[0].size() };
+	rowOffsets.reserve(rows + 1);
 
 	for (size_t i = 0; i < rows; i++)
 	{
 		for (size_t j = 0; j < cols; j++)
 		{
-			if (matrix[i][j].has_value())
+			int state{ targets[i * cols + j] };
+
+			if (state != NoTransition)
 			{
-				matrix[i][j].value().output = outputs[matrix[i][j].value().state];
+				columns.push_back(static_cast<uint32_t>(j));
+				values.push_back(Transition{ state, outputs[state] });
 			}
 		}
+
+		rowOffsets.push_back(values.size());
+	}
+
+	return MachineMatrix::FromRows(rows, cols, std::move(rowOffsets), std::move(columns), std::move(values));
+}
+
+void MapOutputsToStatesInTransitions(MachineMatrix& matrix, const std::vector<int>& outputs)
+{
+	matrix.ForEach([&outputs](size_t, size_t, Transition& transition) {
+		transition.output = outputs[transition.state];
+	});
+}
+
+void WriteMealyCell(OutputBuffer& out, int state, int output)
+{
+	if (state != NoTransition)
+	{
+		out << "S" << state << " Y" << output << " ";
+	}
+	else
+	{
+		out << "- ";
 	}
 }
-} // namespace
\ No newline at end of file
+} // namespace
+} // namespace MooreToMealy
\ No newline at end of file
@@ -1,19 +1,34 @@
 #pragma once
-#include <format>
+#include "../../Common/Automaton.h"
+#include "../../Common/TransitionTable.h"
 #include <fstream>
 #include <iostream>
 #include <map>
-#include <optional>
 #include <vector>
 
+// Moore to Mealy conversion, shared by the MooreToMealy tool, the pipeline and the benchmark
+namespace MooreToMealy
+{
 struct Transition
 {
 	int state;
 	int output;
 };
 
-using MachineMatrix = std::vector<std::vector<std::optional<Transition>>>;
+using MachineMatrix = TransitionTable<Transition>;
 
 MachineMatrix ReadFile(const std::string& filename);
 
-void WriteMealyMachineToStream(const MachineMatrix& matrix, std::ostream& stream = std::cout);
\ No newline at end of file
+// Converts a Moore machine file to a Mealy machine in the text format without building the matrix.
+// The first pass collects the output of every state, the second one writes each Mealy row as soon
+// as its Moore row is parsed, so besides the mapped file only one output per state is kept.
+void ConvertToMealyStream(const std::string& filename, std::ostream& stream = std::cout);
+
+// Mealy machine of a Moore one in memory, a transition outputs what its target state outputs.
+// The transitions are taken over as they are, only the outputs are new.
+Automaton ConvertToMealy(Automaton moore, int threads = 1);
+
+void WriteMealyMachineToStream(const MachineMatrix& matrix, std::ostream& stream = std::cout);
+
+void WriteMealyMachineToBinary(const MachineMatrix& matrix, const std::string& filename);
+} // namespace MooreToMealy
\ No newline at end of file
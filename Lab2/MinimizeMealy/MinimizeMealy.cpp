@@ -1,34 +1,76 @@
-#include "MinimizeMealy.h"
+#include "../../Common/AllocationHooks.h"
+#include "../../Common/MappedFile.h"
+#include "../../Common/OutputBuffer.h"
+#include "../../Common/Stats.h"
+#include "core.h"
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace MinimizeMealy;
 
 int main(int argc, char* argv[])
 try
 {
-	if (argc != 2)
+	int threads = 1;
+	std::string binaryOutput;
+
+	for (int i = 2; i < argc; i += 2)
 	{
-		std::cerr << "Expected one argument: <input file>" << std::endl;
-		return 1;
-	}
+		std::string option = argv[i];
 
-	std::ifstream file(argv[1]);
+		if (option == "--stats")
+		{
+			Stats::Enable();
+			i--;
+			continue;
+		}
+
+		if (i + 1 == argc || (option != "--threads" && option != "--binary"))
+		{
+			argc = 0;
+			break;
+		}
+
+		if (option == "--threads")
+		{
+			threads = std::stoi(argv[i + 1]);
+			threads = threads > 0 ? threads : static_cast<int>(std::thread::hardware_concurrency());
+		}
+		else
+		{
+			binaryOutput = argv[i + 1];
+		}
+	}
 
-	if (!file.is_open())
+	if (argc < 2)
 	{
-		std::cerr << "Cannot open input file" << std::endl;
+		std::cerr << "Expected arguments: <input file> [--threads N] [--binary <output file>] [--stats]" << std::endl;
 		return 1;
 	}
 
-	MachineMatrix matrix;
+	MachineMatrix matrix = LoadMatrix(std::make_shared<MappedFile>(argv[1]), threads);
+	MachineMatrix minimizedMatrix = Minimize(matrix, matrix.rows, matrix.cols, threads);
 
-	int statesCount, inputCount;
-	file >> statesCount >> inputCount;
+	if (!binaryOutput.empty())
+	{
+		WriteMachineMatrixToBinary(minimizedMatrix, binaryOutput);
+	}
+	else
+	{
+		WriteMachineMatrixToStream(minimizedMatrix, minimizedMatrix.rows, minimizedMatrix.cols, std::cout, threads);
+	}
 
-	InitializeMatrix(matrix, statesCount, inputCount);
-	ReadMatrixFromFile(file, matrix, statesCount, inputCount);
+	CheckOutput();
 
-	MachineMatrix minimizedMatrix = Minimize(matrix, statesCount, inputCount);
-	WriteMachineMatrixToStream(minimizedMatrix, minimizedMatrix.size() - 1, inputCount);
+	if (Stats::Enabled())
+	{
+		Stats::Write(std::cerr);
+	}
 }
 catch (const std::exception& e)
 {
 	std::cerr << e.what() << std::endl;
+	return 1;
 }
\ No newline at end of file
@@ -0,0 +1,274 @@
+#pragma once
+#include "../../Common/Stats.h"
+#include <algorithm>
+#include <vector>
+
+// Partition of elements 0..n-1 into blocks that can be split in time
+// proportional to the number of marked elements.
+// Elements of every block occupy a contiguous range of m_elements,
+// marked elements are moved to the front of their block's range.
+class RefinablePartition
+{
+public:
+	RefinablePartition(const std::vector<int>& labels, int labelCount)
+		: m_elements(labels.size())
+		, m_location(labels.size())
+		, m_blockOf(labels)
+		, m_first(labelCount + 1)
+		, m_end(labelCount)
+		, m_marked(labelCount)
+	{
+		for (int label : labels)
+		{
+			m_first[label + 1]++;
+		}
+
+		for (size_t i = 1; i < m_first.size(); i++)
+		{
+			m_first[i] += m_first[i - 1];
+		}
+
+		std::copy(m_first.begin(), m_first.end() - 1, m_end.begin());
+
+		for (size_t i = 0; i < labels.size(); i++)
+		{
+			int position = m_end[labels[i]]++;
+			m_elements[position] = static_cast<int>(i);
+			m_location[i] = position;
+		}
+
+		m_first.pop_back();
+
+		m_touched.reserve(labels.size());
+		m_first.reserve(labels.size());
+		m_end.reserve(labels.size());
+		m_marked.reserve(labels.size());
+	}
+
+	int ElementCount() const
+	{
+		return static_cast<int>(m_elements.size());
+	}
+
+	int BlockCount() const
+	{
+		return static_cast<int>(m_first.size());
+	}
+
+	int BlockOf(int element) const
+	{
+		return m_blockOf[element];
+	}
+
+	int BlockSize(int block) const
+	{
+		return m_end[block] - m_first[block];
+	}
+
+	const int* BlockBegin(int block) const
+	{
+		return m_elements.data() + m_first[block];
+	}
+
+	const int* BlockEnd(int block) const
+	{
+		return m_elements.data() + m_end[block];
+	}
+
+	void Mark(int element)
+	{
+		int block = m_blockOf[element];
+		int position = m_location[element];
+		int markedEnd = m_first[block] + m_marked[block];
+
+		if (position < markedEnd)
+		{
+			return;
+		}
+
+		int other = m_elements[markedEnd];
+		m_elements[position] = other;
+		m_location[other] = position;
+		m_elements[markedEnd] = element;
+		m_location[element] = markedEnd;
+
+		if (m_marked[block]++ == 0)
+		{
+			m_touched.push_back(block);
+		}
+	}
+
+	// Splits every block that has both marked and unmarked elements.
+	// The smaller part always becomes the new block, onSplit(block, newBlock) is called for it.
+	template <typename OnSplit>
+	void SplitMarked(OnSplit&& onSplit)
+	{
+		for (int block : m_touched)
+		{
+			int marked = m_marked[block];
+			m_marked[block] = 0;
+
+			if (marked == BlockSize(block))
+			{
+				continue;
+			}
+
+			int newBlock = BlockCount();
+			int middle = m_first[block] + marked;
+
+			if (marked <= BlockSize(block) - marked)
+			{
+				m_first.push_back(m_first[block]);
+				m_end.push_back(middle);
+				m_first[block] = middle;
+			}
+			else
+			{
+				m_first.push_back(middle);
+				m_end.push_back(m_end[block]);
+				m_end[block] = middle;
+			}
+
+			m_marked.push_back(0);
+
+			for (int i = m_first[newBlock]; i < m_end[newBlock]; i++)
+			{
+				m_blockOf[m_elements[i]] = newBlock;
+			}
+
+			onSplit(block, newBlock);
+		}
+
+		m_touched.clear();
+	}
+
+private:
+	std::vector<int> m_elements;
+	std::vector<int> m_location;
+	std::vector<int> m_blockOf;
+	std::vector<int> m_first;
+	std::vector<int> m_end;
+	std::vector<int> m_marked;
+	std::vector<int> m_touched;
+};
+
+// Predecessors of every state grouped by input symbol, stored contiguously.
+class InverseTransitions
+{
+public:
+	template <typename TargetOf>
+	InverseTransitions(int states, int symbols, TargetOf&& targetOf)
+		: m_states(states)
+		, m_offsets(static_cast<size_t>(states) * symbols + 1)
+		, m_sources(static_cast<size_t>(states) * symbols)
+	{
+		for (int s = 0; s < states; s++)
+		{
+			for (int a = 0; a < symbols; a++)
+			{
+				m_offsets[Key(a, targetOf(s, a)) + 1]++;
+			}
+		}
+
+		for (size_t i = 1; i < m_offsets.size(); i++)
+		{
+			m_offsets[i] += m_offsets[i - 1];
+		}
+
+		std::vector<int> next(m_offsets.begin(), m_offsets.end() - 1);
+
+		for (int s = 0; s < states; s++)
+		{
+			for (int a = 0; a < symbols; a++)
+			{
+				m_sources[next[Key(a, targetOf(s, a))]++] = s;
+			}
+		}
+	}
+
+	const int* Begin(int symbol, int target) const
+	{
+		return m_sources.data() + m_offsets[Key(symbol, target)];
+	}
+
+	const int* End(int symbol, int target) const
+	{
+		return m_sources.data() + m_offsets[Key(symbol, target) + 1];
+	}
+
+private:
+	size_t Key(int symbol, int target) const
+	{
+		return static_cast<size_t>(symbol) * m_states + target;
+	}
+
+	int m_states;
+	std::vector<int> m_offsets;
+	std::vector<int> m_sources;
+};
+
+// Hopcroft's algorithm: refines the partition until it is stable with respect to
+// every (block, symbol) splitter. Only the smaller part of a split block is queued:
+// the larger one is either still queued itself or implied by the already processed union.
+inline void RefinePartition(RefinablePartition& partition, const InverseTransitions& inverse, int symbols)
+{
+	std::vector<int> worklist;
+	std::vector<int> splitter;
+
+	worklist.reserve(partition.ElementCount());
+	splitter.reserve(partition.ElementCount());
+
+	int largest = 0;
+
+	for (int block = 0; block < partition.BlockCount(); block++)
+	{
+		if (partition.BlockSize(block) > partition.BlockSize(largest))
+		{
+			largest = block;
+		}
+	}
+
+	for (int block = 0; block < partition.BlockCount(); block++)
+	{
+		if (block != largest)
+		{
+			worklist.push_back(block);
+		}
+	}
+
+	auto onSplit = [&worklist](int, int newBlock) {
+		worklist.push_back(newBlock);
+	};
+
+	int64_t splitters = 0;
+	size_t longestWorklist = worklist.size();
+
+	while (!worklist.empty())
+	{
+		int block = worklist.back();
+		worklist.pop_back();
+		splitters++;
+
+		splitter.assign(partition.BlockBegin(block), partition.BlockEnd(block));
+
+		for (int a = 0; a < symbols; a++)
+		{
+			for (int target : splitter)
+			{
+				for (const int* it = inverse.Begin(a, target); it != inverse.End(a, target); ++it)
+				{
+					partition.Mark(*it);
+				}
+			}
+
+			partition.SplitMarked(onSplit);
+		}
+
+		longestWorklist = std::max(longestWorklist, worklist.size());
+	}
+
+	Stats::Count("splitters", splitters);
+	Stats::Max("worklist", static_cast<int64_t>(longestWorklist));
+	// The sink's block is not a state of the result
+	Stats::Count("groups", partition.BlockCount() - 1);
+}
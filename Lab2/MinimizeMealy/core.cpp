@@ -0,0 +1,251 @@
+#include "core.h"
+#include "../../Common/OutputBuffer.h"
+#include "../../Common/Parallel.h"
+#include "../../Common/ParallelLoader.h"
+#include "../../Common/Stats.h"
+#include "../../Common/TextScanner.h"
+#include "PartitionRefinement.h"
+#include <algorithm>
+#include <numeric>
+#include <ranges>
+#include <vector>
+
+namespace MinimizeMealy
+{
+namespace
+{
+void InitializeMatrix(MachineMatrix& matrix, int rows, int cols);
+
+void ReadMatrixFromFile(const TextScanner& scanner, MachineMatrix& dest, int rows, int cols, int threads);
+
+MachineMatrix LoadMatrixFromBinary(const BinaryMachine& machine);
+
+RefinablePartition CreateOutputPartition(const MachineMatrix& matrix, int rows, int cols, int threads);
+
+MachineMatrix CreateMachineFromPartition(const MachineMatrix& originalMatrix,
+	const RefinablePartition& partition, int rows, int cols);
+} // namespace
+
+MachineMatrix LoadMatrix(const std::shared_ptr<const MappedFile>& file, int threads)
+{
+	ScopedTimer timer("parse");
+
+	if (IsBinaryMachine(file->Data()))
+	{
+		return LoadMatrixFromBinary(BinaryMachine(file));
+	}
+
+	TextScanner scanner(file->Data());
+
+	scanner.SkipWhitespace();
+	int statesCount = scanner.ReadNumber<int>();
+	scanner.SkipSpaces();
+	int inputCount = scanner.ReadNumber<int>();
+	scanner.ExpectLineEnd();
+
+	MachineMatrix matrix;
+	InitializeMatrix(matrix, statesCount, inputCount);
+	ReadMatrixFromFile(scanner, matrix, statesCount, inputCount, threads);
+
+	return matrix;
+}
+
+MachineMatrix Minimize(const MachineMatrix& matrix, int rows, int cols, int threads)
+{
+	ScopedTimer timer("minimize");
+
+	RefinablePartition partition = CreateOutputPartition(matrix, rows + 1, cols, threads);
+	InverseTransitions inverse(rows + 1, cols, [&matrix](int state, int symbol) {
+		return matrix.Target(state, symbol);
+	});
+
+	RefinePartition(partition, inverse, cols);
+
+	return CreateMachineFromPartition(matrix, partition, rows + 1, cols);
+}
+
+Automaton Minimize(Automaton mealy, int threads)
+{
+	MachineMatrix matrix;
+	matrix.rows = static_cast<int>(mealy.states);
+	matrix.cols = static_cast<int>(mealy.inputs);
+	matrix.transitions = std::move(mealy.transitions);
+	matrix.outputs = std::move(mealy.outputs);
+
+	MachineMatrix minimized = Minimize(matrix, matrix.rows, matrix.cols, threads);
+
+	Automaton result;
+	result.kind = MachineKind::Mealy;
+	result.states = static_cast<size_t>(minimized.rows);
+	result.inputs = static_cast<size_t>(minimized.cols);
+	result.transitions = std::move(minimized.transitions);
+	result.outputs = std::move(minimized.outputs);
+
+	return result;
+}
+
+void WriteMachineMatrixToStream(const MachineMatrix& matrix,
+	int rows, int cols, std::ostream& os, int threads)
+{
+	ScopedTimer timer("write");
+
+	WriteRowsParallel(os, rows, threads, [&matrix, cols](size_t i, OutputBuffer& out) {
+		for (int j = 0; j < cols; j++)
+		{
+			if (matrix.transitions[matrix.Cell(i, j)] != NoTransition)
+			{
+				out << matrix.transitions[matrix.Cell(i, j)] << " " << matrix.outputs[matrix.Cell(i, j)];
+			}
+			else
+			{
+				out << "-";
+			}
+
+			out << " ";
+		}
+
+		out << '\n';
+	});
+}
+
+void WriteMachineMatrixToBinary(const MachineMatrix& matrix, const std::string& filename)
+{
+	ScopedTimer timer("write");
+
+	WriteBinaryMachine(filename, MachineKind::Mealy, matrix.rows, matrix.cols,
+		matrix.transitions.View(), matrix.outputs.View());
+}
+
+namespace
+{
+void InitializeMatrix(MachineMatrix& matrix, int rows, int cols)
+{
+	matrix.rows = rows;
+	matrix.cols = cols;
+	matrix.transitions = MachineArray<int>(static_cast<size_t>(rows) * cols, NoTransition);
+	matrix.outputs = MachineArray<int>(static_cast<size_t>(rows) * cols, -1);
+}
+
+void ReadMatrixFromFile(const TextScanner& scanner, MachineMatrix& dest, int rows, int cols, int threads)
+{
+	ParseRowsParallel(scanner, rows, threads, [&dest, rows, cols](size_t i, TextScanner& row) {
+		for (int j = 0; j < cols; j++)
+		{
+			row.SkipSpaces();
+
+			if (row.SkipStandalone('-'))
+			{
+				continue;
+			}
+
+			int state = row.ReadNumber<int>();
+
+			if (state < 0 || state >= rows)
+			{
+				row.Fail("state " + std::to_string(state) + " is out of range");
+			}
+
+			row.SkipSpaces();
+			dest.transitions[dest.Cell(i, j)] = state;
+			dest.outputs[dest.Cell(i, j)] = row.ReadNumber<int>();
+		}
+	});
+}
+
+// Borrows both tables from the mapped file, nothing is copied
+MachineMatrix LoadMatrixFromBinary(const BinaryMachine& machine)
+{
+	machine.Expect(MachineKind::Mealy);
+
+	MachineMatrix matrix;
+	matrix.rows = static_cast<int>(machine.Header().states);
+	matrix.cols = static_cast<int>(machine.Header().inputs);
+	matrix.transitions = machine.Borrow(machine.Transitions());
+	matrix.outputs = machine.Borrow(machine.Outputs());
+
+	return matrix;
+}
+
+// States are sorted by their rows of outputs, the order of equal rows does not matter.
+// The sink sorts last in a block of its own, so a state with only missing transitions
+// is kept apart from it and only the sink's block is dropped from the result.
+RefinablePartition CreateOutputPartition(const MachineMatrix& matrix, int rows, int cols, int threads)
+{
+	int sink = rows - 1;
+	std::vector<int> order(rows);
+	std::vector<int> buffer;
+	std::vector<size_t> bounds;
+	std::iota(order.begin(), order.end(), 0);
+
+	auto outputs = [&matrix, cols](int state) {
+		return std::views::iota(0, cols) | std::views::transform([&matrix, state](int symbol) {
+			return matrix.Output(state, symbol);
+		});
+	};
+
+	ParallelSort(order, buffer, bounds, threads, [&outputs, sink](int left, int right) {
+		if (left == sink || right == sink)
+		{
+			return right == sink && left != sink;
+		}
+
+		return std::ranges::lexicographical_compare(outputs(left), outputs(right));
+	});
+
+	std::vector<int> labels(rows);
+	int nextLabel = -1;
+
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		if (i == 0 || order[i] == sink || !std::ranges::equal(outputs(order[i - 1]), outputs(order[i])))
+		{
+			nextLabel++;
+		}
+
+		labels[order[i]] = nextLabel;
+	}
+
+	return RefinablePartition(labels, nextLabel + 1);
+}
+
+// States are numbered by their smallest member, the block of the "-" sink state is dropped
+MachineMatrix CreateMachineFromPartition(const MachineMatrix& originalMatrix,
+	const RefinablePartition& partition, int rows, int cols)
+{
+	int sinkBlock = partition.BlockOf(rows - 1);
+	std::vector<int> newState(partition.BlockCount(), NoTransition);
+	std::vector<int> representatives;
+	representatives.reserve(partition.BlockCount());
+
+	for (int state = 0; state < rows; state++)
+	{
+		int block = partition.BlockOf(state);
+
+		if (block != sinkBlock && newState[block] == NoTransition)
+		{
+			newState[block] = static_cast<int>(representatives.size());
+			representatives.push_back(state);
+		}
+	}
+
+	MachineMatrix matrix;
+	InitializeMatrix(matrix, static_cast<int>(representatives.size()), cols);
+
+	for (size_t i = 0; i < representatives.size(); i++)
+	{
+		for (int j = 0; j < cols; j++)
+		{
+			int target = newState[partition.BlockOf(originalMatrix.Target(representatives[i], j))];
+
+			if (target != NoTransition)
+			{
+				matrix.transitions[matrix.Cell(i, j)] = target;
+				matrix.outputs[matrix.Cell(i, j)] = originalMatrix.Output(representatives[i], j);
+			}
+		}
+	}
+
+	return matrix;
+}
+} // namespace
+} // namespace MinimizeMealy
@@ -0,0 +1,52 @@
+#pragma once
+#include "../../Common/Automaton.h"
+#include "../../Common/BinaryMachine.h"
+#include "../../Common/MappedFile.h"
+#include <iostream>
+#include <memory>
+#include <string>
+
+// Mealy machine minimization, shared by the MinimizeMealy tool, the pipeline and the benchmark
+namespace MinimizeMealy
+{
+// Row-major rows x cols tables of target states and outputs, -1 marks a missing transition.
+// Missing transitions lead to the virtual sink state rows, which outputs -1 on every input.
+// Minimize starts the sink in a block of its own, real states never share it.
+struct MachineMatrix
+{
+	int rows = 0;
+	int cols = 0;
+	MachineArray<int> transitions;
+	MachineArray<int> outputs;
+
+	size_t Cell(size_t row, size_t col) const
+	{
+		return row * cols + col;
+	}
+
+	int Target(int state, int symbol) const
+	{
+		int target = state < rows ? transitions[Cell(state, symbol)] : NoTransition;
+		return target != NoTransition ? target : rows;
+	}
+
+	int Output(int state, int symbol) const
+	{
+		return Target(state, symbol) != rows ? outputs[Cell(state, symbol)] : -1;
+	}
+};
+
+// Reads a machine in the text format with the "states inputs" header or in the binary format
+MachineMatrix LoadMatrix(const std::shared_ptr<const MappedFile>& file, int threads = 1);
+
+// Partition refinement, threads only speed up sorting the states by their outputs
+MachineMatrix Minimize(const MachineMatrix& matrix, int rows, int cols, int threads = 1);
+
+// Minimizes a Mealy machine in memory, its arrays are moved into the matrix and not copied
+Automaton Minimize(Automaton mealy, int threads = 1);
+
+void WriteMachineMatrixToStream(const MachineMatrix& matrix,
+	int rows, int cols, std::ostream& os = std::cout, int threads = 1);
+
+void WriteMachineMatrixToBinary(const MachineMatrix& matrix, const std::string& filename);
+} // namespace MinimizeMealy
\ No newline at end of file
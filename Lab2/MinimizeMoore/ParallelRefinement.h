@@ -0,0 +1,136 @@
+#pragma once
+#include "../../Common/Parallel.h"
+#include "../../Common/Stats.h"
+#include <algorithm>
+#include <compare>
+#include <numeric>
+#include <span>
+#include <vector>
+
+// Moore-style refinement over dense state -> group arrays.
+// Every round builds a fixed-width signature (group, groups of successors) per state,
+// sorts states by it and numbers the new groups by (previous group, smallest state).
+// Group arrays are double-buffered and all scratch space is allocated up front,
+// so the rounds themselves allocate nothing apart from the worker threads.
+// transitions holds rows x cols successor indices, where -1 leads to the sink state rows.
+// The sink has no output, the first round puts it into a group of its own, so a real state
+// never ends up with it. The result holds groups of rows + 1 states numbered from 1.
+inline std::vector<int> RefineGroups(std::span<const int> outputs,
+	std::span<const int> transitions, int cols, int threads)
+{
+	size_t sink = outputs.size();
+	size_t rows = sink + 1;
+	size_t width = static_cast<size_t>(cols) + 1;
+
+	std::vector<int> groups(rows, 0);
+	std::vector<int> nextGroups(rows, 0);
+	std::vector<int> signatures(rows * width);
+	std::vector<int> order(rows);
+	std::vector<int> buffer(rows);
+	std::vector<size_t> bounds;
+	std::vector<int> runStarts;
+	std::vector<int> runGroups;
+	std::vector<int> runOrder;
+
+	bounds.reserve(static_cast<size_t>(std::max(threads, 1)) + 1);
+	runStarts.reserve(rows + 1);
+	runGroups.reserve(rows);
+	runOrder.reserve(rows);
+
+	size_t groupsCount = 0;
+	bool firstRound = true;
+
+	while (true)
+	{
+		ParallelFor(threads, rows, [&](size_t begin, size_t end) {
+			for (size_t s = begin; s < end; s++)
+			{
+				int* signature = signatures.data() + s * width;
+				const int* successors = transitions.data() + s * cols;
+
+				signature[0] = groups[s];
+
+				if (firstRound)
+				{
+					// No output can tell a state from the sink, the leading key does
+					signature[0] = s != sink ? 0 : 1;
+					std::fill(signature + 1, signature + width, s != sink ? outputs[s] : 0);
+					continue;
+				}
+
+				for (int j = 0; j < cols; j++)
+				{
+					int successor = s != sink ? successors[j] : -1;
+					signature[j + 1] = groups[successor != -1 ? successor : sink];
+				}
+			}
+		});
+
+		std::iota(order.begin(), order.end(), 0);
+
+		ParallelSort(order, buffer, bounds, threads, [&signatures, width](int left, int right) {
+			const int* l = signatures.data() + left * width;
+			const int* r = signatures.data() + right * width;
+			auto compare = std::lexicographical_compare_three_way(l, l + width, r, r + width);
+
+			return compare < 0 || (compare == 0 && left < right);
+		});
+
+		runStarts.clear();
+
+		for (size_t i = 0; i < rows; i++)
+		{
+			const int* current = signatures.data() + order[i] * width;
+
+			if (i == 0 || !std::equal(current, current + width, signatures.data() + order[i - 1] * width))
+			{
+				runStarts.push_back(static_cast<int>(i));
+			}
+		}
+
+		size_t runs = runStarts.size();
+		runStarts.push_back(static_cast<int>(rows));
+
+		runOrder.resize(runs);
+		std::iota(runOrder.begin(), runOrder.end(), 0);
+
+		std::ranges::sort(runOrder, [&](int left, int right) {
+			int leftState = order[runStarts[left]];
+			int rightState = order[runStarts[right]];
+
+			return std::pair(groups[leftState], leftState) < std::pair(groups[rightState], rightState);
+		});
+
+		runGroups.resize(runs);
+
+		for (size_t i = 0; i < runs; i++)
+		{
+			runGroups[runOrder[i]] = static_cast<int>(i) + 1;
+		}
+
+		ParallelFor(threads, runs, [&](size_t begin, size_t end) {
+			for (size_t run = begin; run < end; run++)
+			{
+				for (int i = runStarts[run]; i < runStarts[run + 1]; i++)
+				{
+					nextGroups[order[i]] = runGroups[run];
+				}
+			}
+		});
+
+		groups.swap(nextGroups);
+		Stats::Count("rounds");
+		// The sink's group is not a state of the result
+		Stats::Sample("groups", static_cast<int64_t>(runs) - 1);
+
+		if (!firstRound && runs == groupsCount)
+		{
+			break;
+		}
+
+		groupsCount = runs;
+		firstRound = false;
+	}
+
+	return groups;
+}
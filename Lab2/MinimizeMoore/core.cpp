@@ -0,0 +1,205 @@
+#include "core.h"
+#include "../../Common/OutputBuffer.h"
+#include "../../Common/ParallelLoader.h"
+#include "../../Common/Stats.h"
+#include "../../Common/TextScanner.h"
+#include "ParallelRefinement.h"
+#include <algorithm>
+#include <ranges>
+#include <vector>
+
+namespace MinimizeMoore
+{
+namespace
+{
+void InitializeMatrix(MachineMatrix& matrix, int rows, int cols);
+
+void ReadMatrixFromFile(const TextScanner& scanner, MachineMatrix& dest, int rows, int cols, int threads);
+
+MachineMatrix LoadMatrixFromBinary(const BinaryMachine& machine);
+
+MachineMatrix CreateMachineFromGroups(const MachineMatrix& originalMatrix, const std::vector<int>& groups);
+} // namespace
+
+MachineMatrix LoadMatrix(const std::shared_ptr<const MappedFile>& file, int threads)
+{
+	ScopedTimer timer("parse");
+
+	if (IsBinaryMachine(file->Data()))
+	{
+		return LoadMatrixFromBinary(BinaryMachine(file));
+	}
+
+	TextScanner scanner(file->Data());
+
+	scanner.SkipWhitespace();
+	int statesCount = scanner.ReadNumber<int>();
+	scanner.SkipSpaces();
+	int inputCount = scanner.ReadNumber<int>();
+	scanner.ExpectLineEnd();
+
+	MachineMatrix matrix;
+	InitializeMatrix(matrix, statesCount, inputCount);
+	ReadMatrixFromFile(scanner, matrix, statesCount, inputCount, threads);
+
+	return matrix;
+}
+
+MachineMatrix Minimize(const MachineMatrix& matrix, int, int cols, int threads)
+{
+	ScopedTimer timer("minimize");
+
+	std::vector<int> groups = RefineGroups(matrix.outputs.View(), matrix.transitions.View(), cols, threads);
+
+	return CreateMachineFromGroups(matrix, groups);
+}
+
+Automaton Minimize(Automaton moore, int threads)
+{
+	MachineMatrix matrix;
+	matrix.rows = static_cast<int>(moore.states);
+	matrix.cols = static_cast<int>(moore.inputs);
+	matrix.outputs = std::move(moore.outputs);
+	matrix.transitions = std::move(moore.transitions);
+
+	MachineMatrix minimized = Minimize(matrix, matrix.rows, matrix.cols, threads);
+
+	Automaton result;
+	result.kind = MachineKind::Moore;
+	result.states = static_cast<size_t>(minimized.rows);
+	result.inputs = static_cast<size_t>(minimized.cols);
+	result.outputs = std::move(minimized.outputs);
+	result.transitions = std::move(minimized.transitions);
+
+	return result;
+}
+
+void WriteMachineMatrixToStream(const MachineMatrix& matrix,
+	int rows, int cols, std::ostream& os, int threads)
+{
+	ScopedTimer timer("write");
+
+	WriteRowsParallel(os, rows, threads, [&matrix, cols](size_t i, OutputBuffer& out) {
+		out << matrix.outputs[i] << " ";
+
+		for (int j = 0; j < cols; j++)
+		{
+			if (matrix.transitions[matrix.Cell(i, j)] != NoTransition)
+			{
+				out << matrix.transitions[matrix.Cell(i, j)];
+			}
+			else
+			{
+				out << "-";
+			}
+
+			out << " ";
+		}
+
+		out << '\n';
+	});
+}
+
+void WriteMachineMatrixToBinary(const MachineMatrix& matrix, const std::string& filename)
+{
+	ScopedTimer timer("write");
+
+	WriteBinaryMachine(filename, MachineKind::Moore, matrix.rows, matrix.cols,
+		matrix.transitions.View(), matrix.outputs.View());
+}
+
+namespace
+{
+void InitializeMatrix(MachineMatrix& matrix, int rows, int cols)
+{
+	matrix.rows = rows;
+	matrix.cols = cols;
+	matrix.outputs = MachineArray<int>(rows, 0);
+	matrix.transitions = MachineArray<int>(static_cast<size_t>(rows) * cols, NoTransition);
+}
+
+void ReadMatrixFromFile(const TextScanner& scanner, MachineMatrix& dest, int rows, int cols, int threads)
+{
+	ParseRowsParallel(scanner, rows, threads, [&dest, rows, cols](size_t i, TextScanner& row) {
+		dest.outputs[i] = row.ReadNumber<int>();
+
+		for (int j = 0; j < cols; j++)
+		{
+			row.SkipSpaces();
+
+			if (row.SkipStandalone('-'))
+			{
+				continue;
+			}
+
+			int state = row.ReadNumber<int>();
+
+			if (state < 0 || state >= rows)
+			{
+				row.Fail("state " + std::to_string(state) + " is out of range");
+			}
+
+			dest.transitions[dest.Cell(i, j)] = state;
+		}
+	});
+}
+
+// Borrows both tables from the mapped file, nothing is copied
+MachineMatrix LoadMatrixFromBinary(const BinaryMachine& machine)
+{
+	machine.Expect(MachineKind::Moore);
+
+	MachineMatrix matrix;
+	matrix.rows = static_cast<int>(machine.Header().states);
+	matrix.cols = static_cast<int>(machine.Header().inputs);
+	matrix.outputs = machine.Borrow(machine.Outputs());
+	matrix.transitions = machine.Borrow(machine.Transitions());
+
+	return matrix;
+}
+
+// Every group becomes a state built from its smallest member, states keep the order of groups.
+// The sink is alone in its group, that group is dropped.
+MachineMatrix CreateMachineFromGroups(const MachineMatrix& originalMatrix, const std::vector<int>& groups)
+{
+	int sinkGroup = groups.back();
+	int groupsCount = std::ranges::max(groups);
+	std::vector<int> newState(groupsCount + 1, NoTransition);
+	std::vector<int> representatives(groupsCount - 1, -1);
+
+	for (int group = 1; group <= groupsCount; group++)
+	{
+		if (group != sinkGroup)
+		{
+			newState[group] = group < sinkGroup ? group - 1 : group - 2;
+		}
+	}
+
+	for (size_t i = 0; i + 1 < groups.size(); i++)
+	{
+		int state = newState[groups[i]];
+
+		if (state != NoTransition && representatives[state] == -1)
+		{
+			representatives[state] = static_cast<int>(i);
+		}
+	}
+
+	MachineMatrix matrix;
+	InitializeMatrix(matrix, static_cast<int>(representatives.size()), originalMatrix.cols);
+
+	for (size_t i = 0; i < representatives.size(); i++)
+	{
+		matrix.outputs[i] = originalMatrix.outputs[representatives[i]];
+
+		for (int j = 0; j < originalMatrix.cols; j++)
+		{
+			int target = originalMatrix.transitions[originalMatrix.Cell(representatives[i], j)];
+			matrix.transitions[matrix.Cell(i, j)] = target != NoTransition ? newState[groups[target]] : NoTransition;
+		}
+	}
+
+	return matrix;
+}
+} // namespace
+} // namespace MinimizeMoore
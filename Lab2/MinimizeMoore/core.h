@@ -0,0 +1,39 @@
+#pragma once
+#include "../../Common/Automaton.h"
+#include "../../Common/BinaryMachine.h"
+#include "../../Common/MappedFile.h"
+#include <iostream>
+#include <memory>
+#include <string>
+
+// Moore machine minimization, shared by the MinimizeMoore tool, the pipeline and the benchmark
+namespace MinimizeMoore
+{
+// Output of every state and row-major rows x cols table of target states,
+// -1 marks a missing transition
+struct MachineMatrix
+{
+	int rows = 0;
+	int cols = 0;
+	MachineArray<int> outputs;
+	MachineArray<int> transitions;
+
+	size_t Cell(size_t row, size_t col) const
+	{
+		return row * cols + col;
+	}
+};
+
+// Reads a machine in the text format with the "states inputs" header or in the binary format
+MachineMatrix LoadMatrix(const std::shared_ptr<const MappedFile>& file, int threads = 1);
+
+MachineMatrix Minimize(const MachineMatrix& matrix, int rows, int cols, int threads = 1);
+
+// Minimizes a Moore machine in memory, its arrays are moved into the matrix and not copied
+Automaton Minimize(Automaton moore, int threads = 1);
+
+void WriteMachineMatrixToStream(const MachineMatrix& matrix,
+	int rows, int cols, std::ostream& os = std::cout, int threads = 1);
+
+void WriteMachineMatrixToBinary(const MachineMatrix& matrix, const std::string& filename);
+} // namespace MinimizeMoore
\ No newline at end of file
@@ -0,0 +1,315 @@
+#include "../../Common/MappedFile.h"
+#include "../../Common/OutputBuffer.h"
+#include "../../Common/TextScanner.h"
+#include "../MinimizeMealy/core.h"
+#include "Transducer.h"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+using namespace MinimizeMealy;
+
+// Runs a Mealy machine (MinimizeMealy input or --binary output) over a stream of input symbols.
+// By default every byte of the input is a symbol and every output is written as a byte,
+// with --text symbols and outputs are decimal numbers separated by whitespace.
+struct Options
+{
+	std::string input = "-";
+	std::string output;
+	bool text = false;
+	int width = 0;
+	int initial = 0;
+};
+
+constexpr size_t BlockSize = size_t{ 1 } << 20;
+
+std::pair<int, int> OutputRange(const MachineMatrix& matrix);
+
+template <typename T>
+size_t Run(const MachineMatrix& matrix, const Options& options, std::istream& input, std::ostream& output);
+
+template <typename T>
+size_t RunBytes(const PackedTransducer<T>& machine, size_t cols, size_t row, std::istream& input, std::ostream& output);
+
+template <typename T>
+size_t RunText(const PackedTransducer<T>& machine, size_t cols, size_t row, std::istream& input, std::ostream& output);
+
+int main(int argc, char* argv[])
+try
+{
+	Options options;
+	int next = 2;
+
+	if (argc > 2 && std::string(argv[2]).rfind("--", 0) != 0)
+	{
+		options.input = argv[next++];
+	}
+
+	for (int i = next; i < argc; i += 2)
+	{
+		std::string option = argv[i];
+
+		if (option == "--text")
+		{
+			options.text = true;
+			i--;
+		}
+		else if (i + 1 < argc && option == "--output")
+		{
+			options.output = argv[i + 1];
+		}
+		else if (i + 1 < argc && option == "--width")
+		{
+			options.width = std::stoi(argv[i + 1]);
+		}
+		else if (i + 1 < argc && option == "--initial")
+		{
+			options.initial = std::stoi(argv[i + 1]);
+		}
+		else
+		{
+			argc = 0;
+			break;
+		}
+	}
+
+	if (argc < 2 || (options.width != 0 && options.width != 8 && options.width != 16 && options.width != 32))
+	{
+		std::cerr << "Expected arguments: <machine file> [<input file>|-] [--output <file>] [--text] "
+					 "[--width 8|16|32] [--initial S]" << std::endl;
+		return 1;
+	}
+
+	MachineMatrix matrix = LoadMatrix(std::make_shared<MappedFile>(argv[1]));
+
+	if (options.initial < 0 || options.initial >= matrix.rows)
+	{
+		throw std::runtime_error("Initial state " + std::to_string(options.initial) + " is out of range");
+	}
+
+	std::ifstream inputFile;
+	std::ofstream outputFile;
+
+#ifdef _WIN32
+	_setmode(_fileno(stdin), _O_BINARY);
+	_setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+	if (options.input != "-")
+	{
+		inputFile.open(options.input, std::ios::binary);
+
+		if (!inputFile.is_open())
+		{
+			throw std::runtime_error("Unable to open file " + options.input);
+		}
+	}
+
+	if (!options.output.empty())
+	{
+		outputFile.open(options.output, std::ios::binary);
+
+		if (!outputFile.is_open())
+		{
+			throw std::runtime_error("Unable to create file " + options.output);
+		}
+	}
+
+	std::istream& input = inputFile.is_open() ? inputFile : std::cin;
+	std::ostream& output = outputFile.is_open() ? static_cast<std::ostream&>(outputFile) : std::cout;
+	std::ios::sync_with_stdio(false);
+
+	auto [minOutput, maxOutput] = OutputRange(matrix);
+
+	if (!options.text && (matrix.cols > 256 || minOutput < 0 || maxOutput > 255))
+	{
+		throw std::runtime_error("Inputs or outputs do not fit into bytes, use --text");
+	}
+
+	int width = options.width;
+
+	if (width == 0)
+	{
+		width = PackedTransducer<uint8_t>::Fits(matrix.rows, matrix.cols, minOutput, maxOutput) ? 8
+			: PackedTransducer<uint16_t>::Fits(matrix.rows, matrix.cols, minOutput, maxOutput) ? 16
+			: 32;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	size_t symbols = width == 8 ? Run<uint8_t>(matrix, options, input, output)
+		: width == 16 ? Run<uint16_t>(matrix, options, input, output)
+		: Run<uint32_t>(matrix, options, input, output);
+	CheckOutput(output);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cerr << symbols << " symbols in " << seconds << " s, "
+			  << static_cast<size_t>(symbols / std::max(seconds, 1e-9)) << " symbols/s, "
+			  << width << "-bit table" << std::endl;
+}
+catch (const std::exception& e)
+{
+	std::cerr << e.what() << std::endl;
+	return 1;
+}
+
+// Smallest and largest output of the existing transitions, both counted from zero
+std::pair<int, int> OutputRange(const MachineMatrix& matrix)
+{
+	int minOutput = 0;
+	int maxOutput = 0;
+
+	for (size_t cell = 0; cell < matrix.transitions.Size(); cell++)
+	{
+		if (matrix.transitions[cell] != NoTransition)
+		{
+			minOutput = std::min(minOutput, matrix.outputs[cell]);
+			maxOutput = std::max(maxOutput, matrix.outputs[cell]);
+		}
+	}
+
+	return { minOutput, maxOutput };
+}
+
+template <typename T>
+size_t Run(const MachineMatrix& matrix, const Options& options, std::istream& input, std::ostream& output)
+{
+	auto [minOutput, maxOutput] = OutputRange(matrix);
+
+	if (!PackedTransducer<T>::Fits(matrix.rows, matrix.cols, minOutput, maxOutput))
+	{
+		throw std::runtime_error("The machine does not fit into a " + std::to_string(sizeof(T) * 8) + "-bit table");
+	}
+
+	PackedTransducer<T> machine(matrix.rows, matrix.cols, matrix.transitions.View(), matrix.outputs.View());
+	size_t row = machine.RowOf(options.initial);
+
+	return options.text
+		? RunText(machine, matrix.cols, row, input, output)
+		: RunBytes(machine, matrix.cols, row, input, output);
+}
+
+template <typename T>
+size_t RunBytes(const PackedTransducer<T>& machine, size_t cols, size_t row, std::istream& input, std::ostream& output)
+{
+	std::vector<uint8_t> symbols(BlockSize);
+	std::vector<uint8_t> outputs(BlockSize);
+	size_t total = 0;
+
+	while (input)
+	{
+		input.read(reinterpret_cast<char*>(symbols.data()), BlockSize);
+		size_t count = static_cast<size_t>(input.gcount());
+		uint8_t maxSymbol = 0;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			maxSymbol = std::max(maxSymbol, symbols[i]);
+		}
+
+		size_t valid = maxSymbol < cols ? count
+			: static_cast<size_t>(std::find_if(symbols.begin(), symbols.begin() + count, [cols](uint8_t symbol) {
+				  return symbol >= cols;
+			  }) - symbols.begin());
+
+		size_t start = row;
+		row = machine.Run(row, symbols.data(), outputs.data(), valid);
+		size_t done = row == machine.SinkRow() ? machine.FindMissing(start, symbols.data(), valid) : valid;
+
+		output.write(reinterpret_cast<const char*>(outputs.data()), static_cast<std::streamsize>(done));
+
+		if (done != count)
+		{
+			output.flush();
+			throw std::runtime_error((done == valid ? "Symbol " : "No transition on symbol ")
+				+ std::to_string(symbols[done]) + " at position " + std::to_string(total + done)
+				+ (done == valid ? " is out of range" : ""));
+		}
+
+		total += count;
+	}
+
+	output.flush();
+
+	return total;
+}
+
+template <typename T>
+size_t RunText(const PackedTransducer<T>& machine, size_t cols, size_t row, std::istream& input, std::ostream& output)
+{
+	std::string buffer;
+	std::vector<uint32_t> symbols;
+	std::vector<int32_t> outputs;
+	OutputBuffer out(output);
+	size_t kept = 0;
+	size_t total = 0;
+
+	while (true)
+	{
+		buffer.resize(kept + BlockSize);
+		input.read(buffer.data() + kept, BlockSize);
+
+		size_t size = kept + static_cast<size_t>(input.gcount());
+		bool last = !input;
+
+		// A number cut by the end of the block is kept for the next one
+		size_t end = last ? size : buffer.find_last_of(" \t\r\n", size - 1) + 1;
+		TextScanner scanner(std::string_view(buffer.data(), end));
+
+		symbols.clear();
+		scanner.SkipWhitespace();
+
+		while (!scanner.AtEnd())
+		{
+			symbols.push_back(scanner.ReadNumber<uint32_t>());
+
+			if (symbols.back() >= cols)
+			{
+				throw std::runtime_error("Symbol " + std::to_string(symbols.back()) + " at position "
+					+ std::to_string(total + symbols.size() - 1) + " is out of range");
+			}
+
+			scanner.SkipWhitespace();
+		}
+
+		outputs.resize(symbols.size());
+
+		size_t start = row;
+		row = machine.Run(row, symbols.data(), outputs.data(), symbols.size());
+		size_t done = row == machine.SinkRow() ? machine.FindMissing(start, symbols.data(), symbols.size()) : symbols.size();
+
+		for (size_t i = 0; i < done; i++)
+		{
+			out << outputs[i] << ' ';
+		}
+
+		if (done != symbols.size())
+		{
+			out.Flush();
+			throw std::runtime_error("No transition on symbol " + std::to_string(symbols[done])
+				+ " at position " + std::to_string(total + done));
+		}
+
+		total += symbols.size();
+		std::memmove(buffer.data(), buffer.data() + end, size - end);
+		kept = size - end;
+
+		if (last)
+		{
+			break;
+		}
+	}
+
+	out << '\n';
+
+	return total;
+}
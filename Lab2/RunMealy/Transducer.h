@@ -0,0 +1,143 @@
+#pragma once
+#include "../../Common/BinaryMachine.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <span>
+
+// Cell of a packed table: offset of the target row (state * cols) and the output
+template <typename T>
+struct TransducerEntry
+{
+	T next;
+	T output;
+};
+
+// Mealy machine laid out for execution in one flat table starting on a cache line.
+// A cell keeps the offset of its target row rather than the state, so a step is a single
+// dependent load. T is uint8_t or uint16_t for small machines to keep the whole table
+// in L1/L2. Missing transitions lead to an extra sink row that loops on itself.
+template <typename T>
+class PackedTransducer
+{
+public:
+	static constexpr size_t CacheLine = 64;
+
+	// Whether every row offset including the sink's and every output fit into T
+	static bool Fits(int rows, int cols, int minOutput, int maxOutput)
+	{
+		return static_cast<uint64_t>(rows) * cols <= std::numeric_limits<T>::max()
+			&& (minOutput >= 0 || sizeof(T) == sizeof(int))
+			&& static_cast<uint64_t>(std::max(maxOutput, 0)) <= std::numeric_limits<T>::max();
+	}
+
+	// A DFA has no outputs, they are all zero then
+	PackedTransducer(int rows, int cols, std::span<const int> transitions, std::span<const int> outputs)
+		: m_cols(cols)
+		, m_sink(static_cast<size_t>(rows) * cols)
+		, m_table(Allocate(m_sink + cols))
+	{
+		for (size_t cell = 0; cell < m_sink; cell++)
+		{
+			bool missing = transitions[cell] == NoTransition;
+			m_table[cell].next = static_cast<T>(missing ? m_sink : static_cast<size_t>(transitions[cell]) * cols);
+			m_table[cell].output = static_cast<T>(missing || outputs.empty() ? 0 : outputs[cell]);
+		}
+
+		for (size_t cell = m_sink; cell < m_sink + cols; cell++)
+		{
+			m_table[cell] = { static_cast<T>(m_sink), 0 };
+		}
+	}
+
+	size_t RowOf(int state) const
+	{
+		return static_cast<size_t>(state) * m_cols;
+	}
+
+	int StateOf(size_t row) const
+	{
+		return static_cast<int>(row / m_cols);
+	}
+
+	size_t SinkRow() const
+	{
+		return m_sink;
+	}
+
+	const TransducerEntry<T>* Data() const
+	{
+		return m_table.get();
+	}
+
+	// Steps over count symbols from the row, writing one output per symbol.
+	// Symbols must be in [0, cols). Returns the row reached, the sink row if a transition was missing.
+	template <typename In, typename Out>
+	size_t Run(size_t row, const In* input, Out* output, size_t count) const
+	{
+		const TransducerEntry<T>* table = m_table.get();
+		size_t i = 0;
+
+		// Unrolled by four, the loads still form one dependency chain but the loop overhead goes away
+		for (; i + 4 <= count; i += 4)
+		{
+			TransducerEntry<T> e0 = table[row + input[i]];
+			output[i] = static_cast<Out>(e0.output);
+			TransducerEntry<T> e1 = table[size_t{ e0.next } + input[i + 1]];
+			output[i + 1] = static_cast<Out>(e1.output);
+			TransducerEntry<T> e2 = table[size_t{ e1.next } + input[i + 2]];
+			output[i + 2] = static_cast<Out>(e2.output);
+			TransducerEntry<T> e3 = table[size_t{ e2.next } + input[i + 3]];
+			output[i + 3] = static_cast<Out>(e3.output);
+			row = e3.next;
+		}
+
+		for (; i < count; i++)
+		{
+			TransducerEntry<T> e = table[row + input[i]];
+			output[i] = static_cast<Out>(e.output);
+			row = e.next;
+		}
+
+		return row;
+	}
+
+	// Index of the first symbol without a transition, for a run that ended in the sink row
+	template <typename In>
+	size_t FindMissing(size_t row, const In* input, size_t count) const
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			row = m_table[row + input[i]].next;
+
+			if (row == m_sink)
+			{
+				return i;
+			}
+		}
+
+		return count;
+	}
+
+private:
+	struct AlignedDelete
+	{
+		void operator()(TransducerEntry<T>* data) const
+		{
+			::operator delete[](data, std::align_val_t{ CacheLine });
+		}
+	};
+
+	static std::unique_ptr<TransducerEntry<T>[], AlignedDelete> Allocate(size_t count)
+	{
+		void* data = ::operator new[](count * sizeof(TransducerEntry<T>), std::align_val_t{ CacheLine });
+		return std::unique_ptr<TransducerEntry<T>[], AlignedDelete>(static_cast<TransducerEntry<T>*>(data));
+	}
+
+	size_t m_cols;
+	size_t m_sink;
+	std::unique_ptr<TransducerEntry<T>[], AlignedDelete> m_table;
+};
@@ -0,0 +1,156 @@
+#pragma once
+#include "Nfa.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace Determinizer
+{
+// Simulates a small NFA directly, the active states live in a few machine words.
+// For every state and symbol the epsilon closure of its targets is precomputed as a mask,
+// a step ORs together the masks of the active states and a word is accepted when the
+// active set ANDed with the final set is not empty. Time is linear in the word length
+// and no DFA states are ever built. Masks are ORed with AVX2 when it is enabled.
+class BitNfa
+{
+public:
+	static constexpr int MaxStates = 512;
+
+	BitNfa(const Table& table, int symbols, const EClosures& closures, const StateSet& finals)
+		: m_states(static_cast<int>(table.size()))
+	{
+		if (m_states > MaxStates)
+		{
+			throw std::runtime_error("Bit-parallel simulation supports up to " + std::to_string(MaxStates) + " states");
+		}
+
+		// Rounded up to a power of two so each width gets its own unrolled kernel
+		m_width = std::bit_ceil(static_cast<size_t>(std::max((m_states + 63) / 64, 1)));
+		m_masks.assign(static_cast<size_t>(symbols) * m_states * m_width, 0);
+		m_start.assign(m_width, 0);
+		m_finals.assign(m_width, 0);
+
+		auto store = [](const StateSet& set, uint64_t* mask) {
+			set.ForEach([mask](int s) {
+				mask[s / 64] |= uint64_t{ 1 } << (s % 64);
+			});
+		};
+
+		for (int a = 0; a < symbols; a++)
+		{
+			for (int s = 0; s < m_states; s++)
+			{
+				for (int target : table[s].content[a])
+				{
+					store(closures[target], Mask(a, s));
+				}
+			}
+		}
+
+		store(closures[0], m_start.data());
+		store(finals, m_finals.data());
+	}
+
+	// Symbols of the word must be in [0, symbols)
+	bool Match(std::span<const int> word) const
+	{
+		switch (m_width)
+		{
+		case 1:
+			return MatchWidth<1>(word);
+		case 2:
+			return MatchWidth<2>(word);
+		case 4:
+			return MatchWidth<4>(word);
+		default:
+			return MatchWidth<8>(word);
+		}
+	}
+
+private:
+	uint64_t* Mask(int symbol, int state)
+	{
+		return m_masks.data() + (static_cast<size_t>(symbol) * m_states + state) * m_width;
+	}
+
+	template <size_t W>
+	static void OrInto(uint64_t* into, const uint64_t* mask)
+	{
+#ifdef __AVX2__
+		if constexpr (W % 4 == 0)
+		{
+			for (size_t i = 0; i < W; i += 4)
+			{
+				__m256i value = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(into + i)),
+					_mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask + i)));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(into + i), value);
+			}
+
+			return;
+		}
+#endif
+		for (size_t i = 0; i < W; i++)
+		{
+			into[i] |= mask[i];
+		}
+	}
+
+	template <size_t W>
+	bool MatchWidth(std::span<const int> word) const
+	{
+		alignas(32) uint64_t current[W];
+		alignas(32) uint64_t next[W];
+		std::copy_n(m_start.data(), W, current);
+
+		for (int symbol : word)
+		{
+			const uint64_t* masks = m_masks.data() + static_cast<size_t>(symbol) * m_states * W;
+			uint64_t any = 0;
+			std::fill_n(next, W, 0);
+
+			for (size_t i = 0; i < W; i++)
+			{
+				for (uint64_t bits = current[i]; bits != 0; bits &= bits - 1)
+				{
+					OrInto<W>(next, masks + (i * 64 + std::countr_zero(bits)) * W);
+				}
+			}
+
+			for (size_t i = 0; i < W; i++)
+			{
+				current[i] = next[i];
+				any |= next[i];
+			}
+
+			if (any == 0)
+			{
+				return false;
+			}
+		}
+
+		for (size_t i = 0; i < W; i++)
+		{
+			if ((current[i] & m_finals[i]) != 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	int m_states;
+	size_t m_width;
+	std::vector<uint64_t> m_masks;
+	std::vector<uint64_t> m_start;
+	std::vector<uint64_t> m_finals;
+};
+} // namespace Determinizer
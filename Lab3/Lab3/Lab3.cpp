@@ -1,202 +1,80 @@
-#include <fstream>
+#include "../../Common/AllocationHooks.h"
+#include "../../Common/BinaryMachine.h"
+#include "../../Common/OutputBuffer.h"
+#include "../../Common/Stats.h"
+#include "Nfa.h"
 #include <iostream>
-#include <map>
-#include <queue>
-#include <set>
-#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
-struct Row
-{
-	Row() = default;
-
-	Row(size_t size)
-	{
-		content.resize(size);
-	}
-
-	int shortName = -1;
-	std::vector<int> fullName;
-	std::vector<std::vector<int>> content;
-};
-
-using Table = std::vector<Row>;
+using namespace Determinizer;
 
-std::tuple<int, int, Table> Read(std::istream& input);
-std::vector<int> Split(const std::string& str, char delim);
-
-std::map<int, std::vector<int>> CreateEClosures(const Table& table);
-std::vector<int> EClose(const Table& table, int state);
-
-int main()
+int main(int argc, char* argv[])
+try
 {
-	std::ifstream input("input.txt");
+	std::string inputName = "input.txt";
+	std::string binaryOutput;
+	int threads = 1;
+	int first = argc > 1 && std::string(argv[1]).rfind("--", 0) != 0 ? 2 : 1;
 
-	if (!input.is_open())
+	if (first == 2)
 	{
-		std::cerr << "Unable to open input file" << std::endl;
-		return 1;
+		inputName = argv[1];
 	}
 
-	auto [countState, countSymbol, baseTable] = Read(input);
-	auto eClosures = CreateEClosures(baseTable);
-	std::queue<std::vector<int>> q;
-	q.push(eClosures[0]);
-	std::vector<int> nextStates;
-	std::vector<int> cellStates;
-	std::set<std::vector<int>> visited;
-	int index = 0;
-
-	Table newTable;
-
-	while (!q.empty())
+	for (int i = first; i < argc; i += 2)
 	{
-		nextStates = q.front();
-		q.pop();
+		std::string option = argv[i];
 
-		if (visited.contains(nextStates))
+		if (option == "--stats")
 		{
+			Stats::Enable();
+			i--;
 			continue;
 		}
 
-		newTable.emplace_back(countSymbol);
-		newTable.back().fullName = nextStates;
-		newTable.back().shortName = index++;
-
-		for (size_t j = 0; j < countSymbol; j++)
+		if (i + 1 == argc || (option != "--threads" && option != "--binary"))
 		{
-			std::set<int> v;
-
-			for (int s : nextStates)
-			{
-				cellStates = baseTable[s].content[j];
-
-				for (int ss : cellStates)
-				{
-					std::vector<int> g = eClosures[ss];
-					std::ranges::copy(g, std::inserter(v, v.end()));
-				}
-			}
-
-			std::copy(v.begin(), v.end(), std::back_inserter(newTable.back().content[j]));
-
-			if (!newTable.back().content[j].empty())
-			{
-				q.push(newTable.back().content[j]);
-			}
+			std::cerr << "Expected arguments: [<input file>] [--threads N] [--binary <output file>] [--stats]" << std::endl;
+			return 1;
 		}
 
-		visited.insert(nextStates);
-	}
-
-	for (size_t i = 0; i < newTable.size(); i++)
-	{
-		for (size_t j = 0; j < newTable[i].content.size(); j++)
+		if (option == "--threads")
 		{
-			auto& cell = newTable[i].content[j];
-			auto it = std::ranges::find_if(newTable, [&cell](const auto& row) {
-				return row.fullName == cell;
-			});
-
-			if (it != newTable.end())
-			{
-				std::cout << it->shortName << " "; 
-			}
-			else
-			{
-				std::cout << "- ";
-			}
+			threads = std::stoi(argv[i + 1]);
+			threads = threads > 0 ? threads : static_cast<int>(std::thread::hardware_concurrency());
+		}
+		else
+		{
+			binaryOutput = argv[i + 1];
 		}
-
-		std::cout << std::endl;
 	}
-}
 
-std::tuple<int, int, Table> Read(std::istream& input)
-{
-	int countState, countSymbol;
-	input >> countState >> countSymbol;
+	auto [countState, countSymbol, baseTable] = ReadNfa(inputName);
+	NfaView nfa(baseTable, countSymbol);
+	auto eClosures = CreateEClosures(nfa);
 
-	Table table;
-	table.resize(static_cast<size_t>(countState));
+	auto [countDfaState, dfa] = Determinize(nfa, countSymbol, eClosures, threads);
 
-	for (auto& row : table)
+	if (!binaryOutput.empty())
 	{
-		row.content.resize(static_cast<size_t>(countSymbol) + 1);
+		WriteBinaryMachine(binaryOutput, MachineKind::Dfa, countDfaState, countSymbol, dfa);
 	}
-
-	std::string token;
-
-	for (int i = 0; i < countState; i++)
+	else
 	{
-		for (int j = 0; j < countSymbol + 1; j++)
-		{
-			input >> token;
-			table[i].shortName = i;
-
-			if (token != "-")
-			{
-				table[i].content[j] = Split(token, ',');
-			}
-		}
+		WriteDfaToStream(countDfaState, countSymbol, dfa);
 	}
 
-	return { countState, countSymbol, table };
-}
-
-std::vector<int> Split(const std::string& str, char delim)
-{
-	std::stringstream ss(str);
-	std::string item;
-	std::vector<int> elems;
+	CheckOutput();
 
-	while (std::getline(ss, item, delim))
+	if (Stats::Enabled())
 	{
-		elems.push_back(stoi(item));
+		Stats::Write(std::cerr);
 	}
-
-	return elems;
 }
-
-std::map<int, std::vector<int>> CreateEClosures(const Table& table)
+catch (const std::exception& e)
 {
-	std::map<int, std::vector<int>> result;
-	for (size_t i = 0; i < table.size(); i++)
-	{
-		result[i] = EClose(table, i);
-	}
-	return result;
+	std::cerr << e.what() << std::endl;
+	return 1;
 }
-
-std::vector<int> EClose(const Table& table, int state)
-{
-	std::vector<int> result;
-	std::set<int> visited;
-	std::queue<int> q;
-	std::vector<int> nextStates;
-	int currState;
-	q.push(state);
-
-	while (!q.empty())
-	{
-		currState = q.front();
-		q.pop();
-
-		if (!visited.contains(currState))
-		{
-			result.push_back(currState);
-			visited.insert(currState);
-
-			nextStates = table[currState].content.back();
-			for (auto& i : nextStates)
-			{
-				q.push(i);
-			}
-			nextStates.clear();
-		}
-	}
-
-	std::ranges::sort(result);
-	return result;
-}
\ No newline at end of file
@@ -0,0 +1,141 @@
+#pragma once
+#include "Nfa.h"
+#include "SubsetTable.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Determinizer
+{
+// DFA built from an NFA on demand while words are matched.
+// A DFA state is created when a word first reaches its subset and its transitions are
+// computed one at a time when first taken. Once the cache holds maxStates states it is
+// flushed and the construction starts over from the subset being entered.
+class LazyDfa
+{
+public:
+	LazyDfa(const Table& table, int symbols, const EClosures& closures, const StateSet& finals, size_t maxStates)
+		: m_table(table)
+		, m_symbols(symbols)
+		, m_closures(closures)
+		, m_finals(finals)
+		, m_maxStates(maxStates)
+		, m_cell(table.size())
+	{
+	}
+
+	// Symbols of the word must be in [0, symbols)
+	bool Match(std::span<const int> word)
+	{
+		int state = m_start != NoTransition ? m_start : (m_start = AddState(m_closures[0]));
+
+		for (int symbol : word)
+		{
+			int32_t next = m_transitions[static_cast<size_t>(state) * m_symbols + symbol];
+
+			if (next == Unknown)
+			{
+				next = Build(state, symbol);
+			}
+
+			if (next == NoTransition)
+			{
+				return false;
+			}
+
+			state = next;
+		}
+
+		return m_accepting[state] != 0;
+	}
+
+	size_t CachedStates() const
+	{
+		return m_accepting.size();
+	}
+
+	size_t BuiltStates() const
+	{
+		return m_builtStates;
+	}
+
+	size_t Flushes() const
+	{
+		return m_flushes;
+	}
+
+private:
+	static constexpr int32_t Unknown = -2;
+
+	int32_t Build(int state, int symbol)
+	{
+		m_cell.Clear();
+
+		m_subsets[state].ForEach([&](int s) {
+			for (int ss : m_table[s].content[symbol])
+			{
+				m_cell |= m_closures[ss];
+			}
+		});
+
+		size_t cell = static_cast<size_t>(state) * m_symbols + symbol;
+
+		if (m_cell.Empty())
+		{
+			return m_transitions[cell] = NoTransition;
+		}
+
+		size_t flushes = m_flushes;
+		int next = AddState(m_cell);
+
+		// After a flush the source state is gone, only the new cache is filled in
+		if (flushes == m_flushes)
+		{
+			m_transitions[cell] = next;
+		}
+
+		return next;
+	}
+
+	int AddState(const StateSet& set)
+	{
+		auto [id, added] = m_subsets.Intern(set);
+
+		if (!added)
+		{
+			return id;
+		}
+
+		if (static_cast<size_t>(m_subsets.Size()) > m_maxStates)
+		{
+			m_subsets.Clear();
+			m_transitions.clear();
+			m_accepting.clear();
+			m_start = NoTransition;
+			m_flushes++;
+
+			id = m_subsets.Intern(set).first;
+		}
+
+		m_transitions.resize(m_transitions.size() + m_symbols, Unknown);
+		m_accepting.push_back(set.Intersects(m_finals) ? 1 : 0);
+		m_builtStates++;
+
+		return id;
+	}
+
+	const Table& m_table;
+	int m_symbols;
+	const EClosures& m_closures;
+	StateSet m_finals;
+	size_t m_maxStates;
+
+	SubsetTable m_subsets;
+	std::vector<int32_t> m_transitions;
+	std::vector<uint8_t> m_accepting;
+	StateSet m_cell;
+	int m_start = NoTransition;
+	size_t m_builtStates = 0;
+	size_t m_flushes = 0;
+};
+} // namespace Determinizer
@@ -0,0 +1,341 @@
+#include "Nfa.h"
+#include "../../Common/MappedFile.h"
+#include "../../Common/OutputBuffer.h"
+#include "../../Common/Stats.h"
+#include "../../Common/TextScanner.h"
+#include "ParallelDeterminizer.h"
+#include "SubsetTable.h"
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+namespace Determinizer
+{
+namespace
+{
+// Table of an NFA in the layout of the binary format
+Table CreateTable(int states, int symbols, std::span<const uint64_t> offsets, std::span<const int32_t> targets);
+} // namespace
+
+std::tuple<int, int, Table> ReadNfa(const std::string& fileName)
+{
+	ScopedTimer timer("parse");
+
+	auto file = std::make_shared<MappedFile>(fileName);
+
+	if (IsBinaryMachine(file->Data()))
+	{
+		return ReadBinary(BinaryMachine(file));
+	}
+
+	return Read(file->Data());
+}
+
+std::tuple<int, int, Table> Read(std::string_view text)
+{
+	TextScanner scanner(text);
+
+	scanner.SkipWhitespace();
+	int countState = scanner.ReadNumber<int>();
+
+	if (countState <= 0)
+	{
+		scanner.Fail("an NFA needs at least one state");
+	}
+
+	scanner.SkipWhitespace();
+	int countSymbol = scanner.ReadNumber<int>();
+
+	if (countSymbol < 0)
+	{
+		scanner.Fail("the number of symbols is negative");
+	}
+
+	Table table;
+	table.resize(static_cast<size_t>(countState));
+
+	for (int i = 0; i < countState; i++)
+	{
+		table[i].shortName = i;
+		table[i].content.resize(static_cast<size_t>(countSymbol) + 1);
+
+		for (int j = 0; j < countSymbol + 1; j++)
+		{
+			scanner.SkipWhitespace();
+
+			if (scanner.SkipStandalone('-'))
+			{
+				continue;
+			}
+
+			// Comma separated targets, every one of them is indexed by the state sets and closures
+			while (true)
+			{
+				int state = scanner.ReadNumber<int>();
+
+				if (state < 0 || state >= countState)
+				{
+					scanner.Fail("state " + std::to_string(state) + " is out of range");
+				}
+
+				table[i].content[j].push_back(state);
+
+				if (scanner.Peek() != ',')
+				{
+					break;
+				}
+
+				scanner.Advance();
+			}
+		}
+	}
+
+	return { countState, countSymbol, table };
+}
+
+std::tuple<int, int, Table> ReadBinary(const BinaryMachine& machine)
+{
+	machine.Expect(MachineKind::Nfa);
+
+	int countState = static_cast<int>(machine.Header().states);
+	int countSymbol = static_cast<int>(machine.Header().inputs);
+
+	if (countState == 0)
+	{
+		throw std::runtime_error("An NFA needs at least one state");
+	}
+
+	return { countState, countSymbol, CreateTable(countState, countSymbol, machine.RowOffsets(), machine.Transitions()) };
+}
+
+std::vector<int> Split(const std::string& str, char delim)
+{
+	std::stringstream ss(str);
+	std::string item;
+	std::vector<int> elems;
+
+	while (std::getline(ss, item, delim))
+	{
+		elems.push_back(stoi(item));
+	}
+
+	return elems;
+}
+
+// Iterative Tarjan over the epsilon graph. Components are completed in reverse topological
+// order, so the closure of a component is its own states united with the already built
+// closures of the components it has edges to, every epsilon edge is looked at twice.
+EClosures CreateEClosures(const NfaView& nfa)
+{
+	ScopedTimer timer("eclosures");
+
+	int n = static_cast<int>(nfa.States());
+	EClosures result;
+	result.component.assign(n, -1);
+
+	std::vector<int> index(n, -1);
+	std::vector<int> lowLink(n, 0);
+	std::vector<bool> onStack(n, false);
+	std::vector<int> stack;
+	std::vector<std::pair<int, size_t>> callStack;
+	std::vector<int> members;
+	std::vector<int> unitedInto;
+	int nextIndex = 0;
+
+	auto visit = [&](int state) {
+		index[state] = lowLink[state] = nextIndex++;
+		stack.push_back(state);
+		onStack[state] = true;
+		callStack.push_back({ state, 0 });
+	};
+
+	for (int root = 0; root < n; root++)
+	{
+		if (index[root] != -1)
+		{
+			continue;
+		}
+
+		visit(root);
+
+		while (!callStack.empty())
+		{
+			auto [state, edge] = callStack.back();
+			std::span<const int> edges = nfa.EpsilonTargets(state);
+
+			if (edge < edges.size())
+			{
+				int next = edges[edge];
+				callStack.back().second++;
+
+				if (index[next] == -1)
+				{
+					visit(next);
+				}
+				else if (onStack[next])
+				{
+					lowLink[state] = std::min(lowLink[state], index[next]);
+				}
+
+				continue;
+			}
+
+			callStack.pop_back();
+
+			if (!callStack.empty())
+			{
+				int parent = callStack.back().first;
+				lowLink[parent] = std::min(lowLink[parent], lowLink[state]);
+			}
+
+			if (lowLink[state] != index[state])
+			{
+				continue;
+			}
+
+			int component = static_cast<int>(result.closures.size());
+			StateSet closure(n);
+			members.clear();
+
+			do
+			{
+				members.push_back(stack.back());
+				stack.pop_back();
+				onStack[members.back()] = false;
+				result.component[members.back()] = component;
+				closure.Insert(members.back());
+			} while (members.back() != state);
+
+			unitedInto.push_back(component);
+
+			for (int member : members)
+			{
+				for (int next : nfa.EpsilonTargets(member))
+				{
+					int other = result.component[next];
+
+					if (unitedInto[other] != component)
+					{
+						unitedInto[other] = component;
+						closure |= result.closures[other];
+					}
+				}
+			}
+
+			result.closures.push_back(std::move(closure));
+		}
+	}
+
+	Stats::Count("eclosure_components", static_cast<int64_t>(result.closures.size()));
+
+	return result;
+}
+
+std::pair<int, std::vector<int32_t>> Determinize(const NfaView& nfa, int symbols, const EClosures& closures, int threads)
+{
+	ScopedTimer timer("determinize");
+
+	// Every cell is the union of the closures of all targets
+	auto computeCell = [&](const StateSet& from, size_t symbol, StateSet& cell) {
+		cell.Clear();
+
+		from.ForEach([&](int s) {
+			for (int ss : nfa.Targets(s, symbol))
+			{
+				cell |= closures[ss];
+			}
+		});
+	};
+
+	if (threads > 1)
+	{
+		auto result = DeterminizeParallel(closures[0], symbols, threads, computeCell);
+		Stats::Count("dfa_states", result.first);
+
+		return result;
+	}
+
+	// Subsets get IDs in the order they are first met. This is the order a FIFO queue
+	// would first hand them out in, so the IDs themselves serve as the queue.
+	SubsetTable subsets;
+	subsets.Intern(closures[0]);
+
+	std::vector<int32_t> dfa;
+	StateSet cell(nfa.States());
+
+	for (int current = 0; current < subsets.Size(); current++)
+	{
+		for (size_t j = 0; j < static_cast<size_t>(symbols); j++)
+		{
+			computeCell(subsets[current], j, cell);
+			dfa.push_back(cell.Empty() ? NoTransition : subsets.Intern(cell).first);
+		}
+	}
+
+	Stats::Count("dfa_states", subsets.Size());
+
+	return { subsets.Size(), std::move(dfa) };
+}
+
+Automaton Determinize(const Automaton& nfa, int threads)
+{
+	int symbols = static_cast<int>(nfa.inputs);
+	NfaView view(nfa.states, symbols, nfa.rowOffsets.View(), nfa.transitions.View());
+	EClosures closures = CreateEClosures(view);
+	auto [states, transitions] = Determinize(view, symbols, closures, threads);
+
+	Automaton dfa;
+	dfa.kind = MachineKind::Dfa;
+	dfa.states = static_cast<size_t>(states);
+	dfa.inputs = static_cast<size_t>(symbols);
+	dfa.transitions = MachineArray<int32_t>(std::move(transitions));
+
+	return dfa;
+}
+
+void WriteDfaToStream(int states, int symbols, const std::vector<int32_t>& dfa, std::ostream& stream)
+{
+	ScopedTimer timer("write");
+
+	OutputBuffer out(stream);
+
+	for (size_t i = 0; i < static_cast<size_t>(states); i++)
+	{
+		for (size_t j = 0; j < static_cast<size_t>(symbols); j++)
+		{
+			if (int state = dfa[i * symbols + j]; state != NoTransition)
+			{
+				out << state << " ";
+			}
+			else
+			{
+				out << "- ";
+			}
+		}
+
+		out << '\n';
+	}
+}
+
+namespace
+{
+Table CreateTable(int states, int symbols, std::span<const uint64_t> offsets, std::span<const int32_t> targets)
+{
+	Table table(states, Row(static_cast<size_t>(symbols) + 1));
+
+	for (int i = 0; i < states; i++)
+	{
+		table[i].shortName = i;
+
+		for (int j = 0; j < symbols + 1; j++)
+		{
+			size_t cell = static_cast<size_t>(i) * (symbols + 1) + j;
+			table[i].content[j].assign(targets.begin() + offsets[cell], targets.begin() + offsets[cell + 1]);
+		}
+	}
+
+	return table;
+}
+} // namespace
+} // namespace Determinizer
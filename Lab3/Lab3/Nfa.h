@@ -0,0 +1,112 @@
+#pragma once
+#include "../../Common/Automaton.h"
+#include "../../Common/BinaryMachine.h"
+#include "StateSet.h"
+#include <cstdint>
+#include <iostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// NFA determinization, shared by Lab3, Match, the pipeline and the benchmark
+namespace Determinizer
+{
+struct Row
+{
+	Row() = default;
+
+	Row(size_t size)
+	{
+		content.resize(size);
+	}
+
+	int shortName = -1;
+	std::vector<std::vector<int>> content;
+};
+
+using Table = std::vector<Row>;
+
+// Targets of every state and column of an NFA with the epsilon column last,
+// read from a Table or in place from the arrays of the binary format
+class NfaView
+{
+public:
+	NfaView(const Table& table, int symbols)
+		: m_table(&table)
+		, m_states(table.size())
+		, m_symbols(static_cast<size_t>(symbols))
+	{
+	}
+
+	NfaView(size_t states, int symbols, std::span<const uint64_t> offsets, std::span<const int32_t> targets)
+		: m_states(states)
+		, m_symbols(static_cast<size_t>(symbols))
+		, m_offsets(offsets)
+		, m_targets(targets)
+	{
+	}
+
+	size_t States() const
+	{
+		return m_states;
+	}
+
+	std::span<const int> Targets(int state, size_t column) const
+	{
+		if (m_table != nullptr)
+		{
+			return (*m_table)[state].content[column];
+		}
+
+		size_t cell = static_cast<size_t>(state) * (m_symbols + 1) + column;
+
+		return m_targets.subspan(m_offsets[cell], m_offsets[cell + 1] - m_offsets[cell]);
+	}
+
+	std::span<const int> EpsilonTargets(int state) const
+	{
+		return Targets(state, m_symbols);
+	}
+
+private:
+	const Table* m_table = nullptr;
+	size_t m_states;
+	size_t m_symbols;
+	std::span<const uint64_t> m_offsets;
+	std::span<const int32_t> m_targets;
+};
+
+// Epsilon closures shared by all states of a strongly connected component of the epsilon graph
+struct EClosures
+{
+	std::vector<int> component;
+	std::vector<StateSet> closures;
+
+	const StateSet& operator[](int state) const
+	{
+		return closures[component[state]];
+	}
+};
+
+// Reads an NFA in the Lab3 text format or in the binary format.
+// Returns the number of states, the number of symbols and the table.
+std::tuple<int, int, Table> ReadNfa(const std::string& fileName);
+std::tuple<int, int, Table> Read(std::string_view text);
+std::tuple<int, int, Table> ReadBinary(const BinaryMachine& machine);
+std::vector<int> Split(const std::string& str, char delim);
+
+EClosures CreateEClosures(const NfaView& nfa);
+
+// Subset construction from the closure of state 0, on several threads if threads > 1.
+// Returns the number of DFA states and row-major states x symbols transitions, -1 marks a missing one.
+std::pair<int, std::vector<int32_t>> Determinize(const NfaView& nfa, int symbols, const EClosures& closures,
+	int threads = 1);
+
+// DFA of an NFA in memory, its arrays are read in place
+Automaton Determinize(const Automaton& nfa, int threads = 1);
+
+void WriteDfaToStream(int states, int symbols, const std::vector<int32_t>& dfa, std::ostream& stream = std::cout);
+} // namespace Determinizer
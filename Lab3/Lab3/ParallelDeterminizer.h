@@ -0,0 +1,175 @@
+#pragma once
+#include "../../Common/Parallel.h"
+#include "SubsetTable.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Subset construction on several threads.
+// Subsets are interned in shards picked by their hash, each shard behind its own mutex,
+// and get temporary IDs made of the shard and the index in it. Every worker expands
+// subsets from the back of its own queue and steals from the front of the others' queues
+// when it runs dry. Once every subset is expanded, a breadth-first pass over the rows
+// renumbers the states exactly as the serial construction does.
+// computeCell(subset, symbol, cell) stores the successor of subset on symbol in cell.
+// Returns the number of DFA states and its row-major states x symbols transitions.
+template <typename ComputeCell>
+std::pair<int, std::vector<int32_t>> DeterminizeParallel(const StateSet& start, size_t symbols, int threads,
+	ComputeCell&& computeCell)
+{
+	constexpr int64_t ShardCount = 64;
+
+	struct Shard
+	{
+		std::mutex mutex;
+		SubsetTable subsets;
+		std::deque<std::vector<int64_t>> rows;
+	};
+
+	struct Task
+	{
+		const StateSet* subset = nullptr;
+		std::vector<int64_t>* row = nullptr;
+	};
+
+	struct WorkQueue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	std::vector<Shard> shards(ShardCount);
+	std::vector<WorkQueue> queues(threads);
+	std::atomic<size_t> pending = 0;
+
+	// Returns the temporary ID, task is only filled in for a subset seen for the first time
+	auto intern = [&shards](const StateSet& set, Task& task) {
+		size_t hash = set.Hash();
+		int64_t index = (static_cast<uint32_t>(hash) * 0x9E3779B1u) >> 26;
+		Shard& shard = shards[index];
+		std::lock_guard lock(shard.mutex);
+
+		auto [id, added] = shard.subsets.Intern(set, hash);
+
+		if (added)
+		{
+			shard.rows.emplace_back();
+			task = { &shard.subsets[id], &shard.rows.back() };
+		}
+
+		return id * ShardCount + index;
+	};
+
+	auto push = [&queues, &pending](size_t worker, const Task& task) {
+		pending++;
+		std::lock_guard lock(queues[worker].mutex);
+		queues[worker].tasks.push_back(task);
+	};
+
+	auto take = [&queues, threads](size_t worker, Task& task) {
+		for (size_t i = 0; i < static_cast<size_t>(threads); i++)
+		{
+			WorkQueue& queue = queues[(worker + i) % threads];
+			std::lock_guard lock(queue.mutex);
+
+			if (!queue.tasks.empty())
+			{
+				task = i == 0 ? queue.tasks.back() : queue.tasks.front();
+				i == 0 ? queue.tasks.pop_back() : queue.tasks.pop_front();
+				return true;
+			}
+		}
+
+		return false;
+	};
+
+	Task first;
+	int64_t startId = intern(start, first);
+	push(0, first);
+
+	ParallelFor(threads, threads, [&](size_t begin, size_t end) {
+		for (size_t worker = begin; worker < end; worker++)
+		{
+			StateSet cell = start;
+			Task task;
+
+			while (pending != 0)
+			{
+				if (!take(worker, task))
+				{
+					std::this_thread::yield();
+					continue;
+				}
+
+				task.row->resize(symbols);
+
+				for (size_t j = 0; j < symbols; j++)
+				{
+					computeCell(*task.subset, j, cell);
+
+					if (cell.Empty())
+					{
+						(*task.row)[j] = -1;
+						continue;
+					}
+
+					Task added;
+					(*task.row)[j] = intern(cell, added);
+
+					if (added.subset != nullptr)
+					{
+						push(worker, added);
+					}
+				}
+
+				pending--;
+			}
+		}
+	});
+
+	std::vector<size_t> offsets(ShardCount + 1, 0);
+
+	for (int64_t i = 0; i < ShardCount; i++)
+	{
+		offsets[i + 1] = offsets[i] + shards[i].rows.size();
+	}
+
+	auto flatIndex = [&offsets](int64_t id) {
+		return offsets[id % ShardCount] + static_cast<size_t>(id / ShardCount);
+	};
+
+	std::vector<int> newId(offsets[ShardCount], -1);
+	std::vector<int64_t> order{ startId };
+	std::vector<int32_t> dfa;
+
+	newId[flatIndex(startId)] = 0;
+	dfa.reserve(offsets[ShardCount] * symbols);
+
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		for (int64_t next : shards[order[i] % ShardCount].rows[order[i] / ShardCount])
+		{
+			if (next == -1)
+			{
+				dfa.push_back(-1);
+				continue;
+			}
+
+			int& id = newId[flatIndex(next)];
+
+			if (id == -1)
+			{
+				id = static_cast<int>(order.size());
+				order.push_back(next);
+			}
+
+			dfa.push_back(id);
+		}
+	}
+
+	return { static_cast<int>(order.size()), std::move(dfa) };
+}
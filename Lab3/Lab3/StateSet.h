@@ -0,0 +1,112 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Set of NFA states 0..capacity-1 stored as a dense bitset.
+// Union and comparison work word by word in plain loops the compiler vectorizes.
+class StateSet
+{
+public:
+	StateSet() = default;
+
+	explicit StateSet(size_t capacity)
+		: m_words((capacity + 63) / 64, 0)
+	{
+	}
+
+	void Insert(int state)
+	{
+		m_words[state / 64] |= uint64_t{ 1 } << (state % 64);
+	}
+
+	bool Contains(int state) const
+	{
+		return (m_words[state / 64] >> (state % 64)) & 1;
+	}
+
+	bool Empty() const
+	{
+		for (uint64_t word : m_words)
+		{
+			if (word != 0)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool Intersects(const StateSet& other) const
+	{
+		for (size_t i = 0; i < m_words.size(); i++)
+		{
+			if ((m_words[i] & other.m_words[i]) != 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void Clear()
+	{
+		std::fill(m_words.begin(), m_words.end(), 0);
+	}
+
+	StateSet& operator|=(const StateSet& other)
+	{
+		uint64_t* words = m_words.data();
+		const uint64_t* otherWords = other.m_words.data();
+
+		for (size_t i = 0; i < m_words.size(); i++)
+		{
+			words[i] |= otherWords[i];
+		}
+
+		return *this;
+	}
+
+	friend bool operator==(const StateSet& left, const StateSet& right) = default;
+
+	size_t Hash() const
+	{
+		uint64_t hash = 0x9E3779B97F4A7C15ull;
+
+		for (uint64_t word : m_words)
+		{
+			hash = (hash ^ word) * 0xBF58476D1CE4E5B9ull;
+			hash ^= hash >> 31;
+		}
+
+		return static_cast<size_t>(hash);
+	}
+
+	// Calls fn(state) for every state of the set in ascending order
+	template <typename Fn>
+	void ForEach(Fn&& fn) const
+	{
+		for (size_t i = 0; i < m_words.size(); i++)
+		{
+			for (uint64_t word = m_words[i]; word != 0; word &= word - 1)
+			{
+				fn(static_cast<int>(i * 64 + std::countr_zero(word)));
+			}
+		}
+	}
+
+private:
+	std::vector<uint64_t> m_words;
+};
+
+struct StateSetHash
+{
+	size_t operator()(const StateSet& set) const
+	{
+		return set.Hash();
+	}
+};
@@ -0,0 +1,103 @@
+#pragma once
+#include "StateSet.h"
+#include <algorithm>
+#include <deque>
+#include <utility>
+#include <vector>
+
+// Interns subsets of NFA states: every distinct subset is hashed once and gets
+// the next dense ID, later lookups compare against cached hashes first.
+// Open addressing with linear probing, the slot array is kept at most half full.
+// Stored subsets never move, references to them stay valid while the table grows.
+class SubsetTable
+{
+public:
+	SubsetTable()
+		: m_slots(1024, Empty)
+	{
+	}
+
+	int Size() const
+	{
+		return static_cast<int>(m_sets.size());
+	}
+
+	const StateSet& operator[](int id) const
+	{
+		return m_sets[id];
+	}
+
+	// Forgets all subsets, IDs are handed out from zero again
+	void Clear()
+	{
+		m_sets.clear();
+		m_hashes.clear();
+		std::fill(m_slots.begin(), m_slots.end(), Empty);
+	}
+
+	// Returns the ID of the subset and whether it has just been added
+	std::pair<int, bool> Intern(const StateSet& set)
+	{
+		return Intern(set, set.Hash());
+	}
+
+	std::pair<int, bool> Intern(const StateSet& set, size_t hash)
+	{
+		size_t slot = Find(set, hash);
+
+		if (m_slots[slot] != Empty)
+		{
+			return { m_slots[slot], false };
+		}
+
+		int id = Size();
+		m_sets.push_back(set);
+		m_hashes.push_back(hash);
+		m_slots[slot] = id;
+
+		if (m_sets.size() * 2 > m_slots.size())
+		{
+			Grow();
+		}
+
+		return { id, true };
+	}
+
+private:
+	static constexpr int Empty = -1;
+
+	size_t Find(const StateSet& set, size_t hash) const
+	{
+		size_t mask = m_slots.size() - 1;
+		size_t slot = hash & mask;
+
+		while (m_slots[slot] != Empty && (m_hashes[m_slots[slot]] != hash || m_sets[m_slots[slot]] != set))
+		{
+			slot = (slot + 1) & mask;
+		}
+
+		return slot;
+	}
+
+	void Grow()
+	{
+		m_slots.assign(m_slots.size() * 2, Empty);
+		size_t mask = m_slots.size() - 1;
+
+		for (size_t id = 0; id < m_sets.size(); id++)
+		{
+			size_t slot = m_hashes[id] & mask;
+
+			while (m_slots[slot] != Empty)
+			{
+				slot = (slot + 1) & mask;
+			}
+
+			m_slots[slot] = static_cast<int>(id);
+		}
+	}
+
+	std::deque<StateSet> m_sets;
+	std::vector<size_t> m_hashes;
+	std::vector<int> m_slots;
+};
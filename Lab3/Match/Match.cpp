@@ -0,0 +1,150 @@
+#include "../../Common/MappedFile.h"
+#include "../../Common/OutputBuffer.h"
+#include "../../Common/TextScanner.h"
+#include "../Lab3/BitNfa.h"
+#include "../Lab3/LazyDfa.h"
+#include "../Lab3/Nfa.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace Determinizer;
+
+// Matches words against an NFA in the Lab3 format without determinizing it in advance.
+// Every line of the words file is a word given as symbol indices separated by spaces,
+// for each of them "1" is printed if the NFA accepts it and "0" otherwise.
+// The lazy engine builds DFA states on demand, the bits engine simulates NFAs of up to
+// BitNfa::MaxStates states on bitsets and never builds any.
+int main(int argc, char* argv[])
+try
+{
+	std::vector<int> finals;
+	size_t cacheStates = 65536;
+	std::string engine = "lazy";
+
+	for (int i = 3; i < argc; i += 2)
+	{
+		std::string option = argv[i];
+
+		if (i + 1 == argc || (option != "--final" && option != "--cache" && option != "--engine"))
+		{
+			argc = 0;
+			break;
+		}
+
+		if (option == "--final")
+		{
+			finals = Split(argv[i + 1], ',');
+		}
+		else if (option == "--cache")
+		{
+			cacheStates = std::stoul(argv[i + 1]);
+		}
+		else
+		{
+			engine = argv[i + 1];
+		}
+	}
+
+	if (argc < 3 || finals.empty() || cacheStates == 0 || (engine != "lazy" && engine != "bits"))
+	{
+		std::cerr << "Expected arguments: <nfa file> <words file|-> --final S[,S...] [--cache N] [--engine lazy|bits]" << std::endl
+				  << "N is the most DFA states kept at once, the cache is flushed when it is full" << std::endl;
+		return 1;
+	}
+
+	auto [countState, countSymbol, table] = ReadNfa(argv[1]);
+	auto eClosures = CreateEClosures(NfaView(table, countSymbol));
+	StateSet finalSet(countState);
+
+	for (int state : finals)
+	{
+		if (state < 0 || state >= countState)
+		{
+			throw std::runtime_error("Final state " + std::to_string(state) + " is out of range");
+		}
+
+		finalSet.Insert(state);
+	}
+
+	std::string words = argv[2];
+	std::shared_ptr<MappedFile> file;
+	std::string text;
+
+	if (words == "-")
+	{
+		text.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+	}
+	else
+	{
+		file = std::make_shared<MappedFile>(words);
+	}
+
+	TextScanner scanner(file ? file->Data() : std::string_view(text));
+	std::optional<LazyDfa> dfa;
+	std::optional<BitNfa> nfa;
+
+	if (engine == "bits")
+	{
+		nfa.emplace(table, countSymbol, eClosures, finalSet);
+	}
+	else
+	{
+		dfa.emplace(table, countSymbol, eClosures, finalSet, cacheStates);
+	}
+
+	OutputBuffer out(std::cout);
+	std::vector<int> word;
+	size_t countWord = 0;
+	size_t countInput = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	while (!scanner.AtEnd())
+	{
+		word.clear();
+		scanner.SkipSpaces();
+
+		while (!scanner.AtEnd() && scanner.Peek() != '\n')
+		{
+			int symbol = scanner.ReadNumber<int>();
+
+			if (symbol < 0 || symbol >= countSymbol)
+			{
+				scanner.Fail("symbol " + std::to_string(symbol) + " is out of range");
+			}
+
+			word.push_back(symbol);
+			scanner.SkipSpaces();
+		}
+
+		scanner.ExpectLineEnd();
+		out << ((nfa ? nfa->Match(word) : dfa->Match(word)) ? "1\n" : "0\n");
+		countWord++;
+		countInput += word.size();
+	}
+
+	out.Flush();
+	CheckOutput();
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cerr << countWord << " words, " << countInput << " symbols in " << seconds << " s, "
+			  << static_cast<size_t>(countInput / std::max(seconds, 1e-9)) << " symbols/s" << std::endl;
+
+	if (dfa)
+	{
+		std::cerr << dfa->BuiltStates() << " DFA states built, " << dfa->CachedStates() << " cached, "
+				  << dfa->Flushes() << " flushes" << std::endl;
+	}
+}
+catch (const std::exception& e)
+{
+	std::cerr << e.what() << std::endl;
+	return 1;
+}
@@ -0,0 +1,218 @@
+#include "../../Common/BinaryMachine.h"
+#include "../../Common/MappedFile.h"
+#include "../../Common/OutputBuffer.h"
+#include "../../Common/TextScanner.h"
+#include "BatchRunner.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Runs a DFA (Lab3 --binary output) or a Mealy machine (MinimizeMealy --binary output) over
+// many independent words. Every line of the words file is a word of symbol indices separated
+// by spaces. For every word the state reached is printed, followed by the output of its last
+// transition for a Mealy machine, or "-" if the word took a missing transition.
+WordBatch ReadWords(std::string_view text, size_t symbols);
+double Measure(const std::function<void()>& run);
+
+int main(int argc, char* argv[])
+try
+{
+	int initial = 0;
+	std::string mode = "auto";
+	bool compare = false;
+
+	for (int i = 3; i < argc; i += 2)
+	{
+		std::string option = argv[i];
+
+		if (option == "--compare")
+		{
+			compare = true;
+			i--;
+		}
+		else if (i + 1 < argc && option == "--initial")
+		{
+			initial = std::stoi(argv[i + 1]);
+		}
+		else if (i + 1 < argc && option == "--mode")
+		{
+			mode = argv[i + 1];
+		}
+		else
+		{
+			argc = 0;
+			break;
+		}
+	}
+
+	if (argc < 3 || (mode != "auto" && mode != "serial" && mode != "interleaved" && mode != "gather"))
+	{
+		std::cerr << "Expected arguments: <binary machine file> <words file> [--initial S] "
+					 "[--mode auto|serial|interleaved|gather] [--compare]" << std::endl
+				  << "--compare also runs the words one at a time and reports both rates" << std::endl;
+		return 1;
+	}
+
+	BinaryMachine machine(std::make_shared<MappedFile>(argv[1]));
+	bool mealy = machine.Header().kind == MachineKind::Mealy;
+	machine.Expect(mealy ? MachineKind::Mealy : MachineKind::Dfa);
+
+	int rows = static_cast<int>(machine.Header().states);
+	int cols = static_cast<int>(machine.Header().inputs);
+
+	if (initial < 0 || initial >= rows)
+	{
+		throw std::runtime_error("Initial state " + std::to_string(initial) + " is out of range");
+	}
+
+	MappedFile wordsFile(argv[2]);
+	WordBatch words = ReadWords(wordsFile.Data(), cols);
+
+	int minOutput = 0;
+	int maxOutput = 0;
+
+	for (size_t cell = 0; cell < machine.Outputs().size(); cell++)
+	{
+		if (machine.Transitions()[cell] != NoTransition)
+		{
+			minOutput = std::min(minOutput, machine.Outputs()[cell]);
+			maxOutput = std::max(maxOutput, machine.Outputs()[cell]);
+		}
+	}
+
+	bool narrow = PackedTransducer<uint16_t>::Fits(rows, cols, minOutput, maxOutput)
+		&& words.symbols.size() < static_cast<size_t>(INT32_MAX);
+	std::vector<WordResult> results(words.Count());
+	std::function<void()> run;
+	std::function<void()> serial;
+	std::function<size_t(size_t)> stateOf;
+	size_t sink = 0;
+
+	auto setUp = [&](const auto& packed) {
+		size_t start = packed.RowOf(initial);
+		stateOf = [&packed](size_t row) { return static_cast<size_t>(packed.StateOf(row)); };
+		sink = packed.SinkRow();
+		serial = [&packed, start, &words, &results] { RunSerial(packed, start, words, results); };
+		run = mode == "serial" ? serial : [&packed, start, &words, &results] { RunInterleaved(packed, start, words, results); };
+	};
+
+	std::unique_ptr<PackedTransducer<uint16_t>> packed16;
+	std::unique_ptr<PackedTransducer<uint32_t>> packed32;
+
+	if (narrow)
+	{
+		packed16 = std::make_unique<PackedTransducer<uint16_t>>(rows, cols, machine.Transitions(), machine.Outputs());
+		setUp(*packed16);
+#ifdef __AVX2__
+		if (mode == "auto" || mode == "gather")
+		{
+			run = [&packed16, &words, &results, initial] { RunGather(*packed16, packed16->RowOf(initial), words, results); };
+		}
+#endif
+	}
+	else
+	{
+		packed32 = std::make_unique<PackedTransducer<uint32_t>>(rows, cols, machine.Transitions(), machine.Outputs());
+		setUp(*packed32);
+	}
+
+#ifdef __AVX2__
+	if (mode == "gather" && !narrow)
+	{
+		throw std::runtime_error("Gathers need a machine that fits into a 16-bit table");
+	}
+#else
+	if (mode == "gather")
+	{
+		throw std::runtime_error("Gathers need a build with AVX2 enabled");
+	}
+#endif
+
+	double seconds = Measure(run);
+
+	std::cerr << words.Count() << " words, " << words.symbols.size() << " symbols in " << seconds << " s, "
+			  << static_cast<size_t>(words.Count() / std::max(seconds, 1e-9)) << " words/s" << std::endl;
+
+	if (compare)
+	{
+		std::vector<WordResult> batchResults = results;
+		double serialSeconds = Measure(serial);
+
+		if (batchResults != results)
+		{
+			throw std::runtime_error("Batch results differ from the one-at-a-time run");
+		}
+
+		std::cerr << "One at a time: " << serialSeconds << " s, "
+				  << static_cast<size_t>(words.Count() / std::max(serialSeconds, 1e-9)) << " words/s, "
+				  << serialSeconds / std::max(seconds, 1e-9) << "x slower" << std::endl;
+	}
+
+	OutputBuffer out(std::cout);
+
+	for (const WordResult& result : results)
+	{
+		if (result.row == sink)
+		{
+			out << "-\n";
+			continue;
+		}
+
+		out << stateOf(result.row);
+
+		if (mealy && result.output != -1)
+		{
+			out << ' ' << result.output;
+		}
+
+		out << '\n';
+	}
+
+	out.Flush();
+	CheckOutput();
+}
+catch (const std::exception& e)
+{
+	std::cerr << e.what() << std::endl;
+	return 1;
+}
+
+WordBatch ReadWords(std::string_view text, size_t symbols)
+{
+	TextScanner scanner(text);
+	WordBatch words;
+
+	while (!scanner.AtEnd())
+	{
+		scanner.SkipSpaces();
+
+		while (!scanner.AtEnd() && scanner.Peek() != '\n')
+		{
+			int32_t symbol = scanner.ReadNumber<int32_t>();
+
+			if (symbol < 0 || static_cast<size_t>(symbol) >= symbols)
+			{
+				scanner.Fail("symbol " + std::to_string(symbol) + " is out of range");
+			}
+
+			words.symbols.push_back(symbol);
+			scanner.SkipSpaces();
+		}
+
+		scanner.ExpectLineEnd();
+		words.offsets.push_back(words.symbols.size());
+	}
+
+	return words;
+}
+
+double Measure(const std::function<void()>& run)
+{
+	auto start = std::chrono::steady_clock::now();
+	run();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,207 @@
+#pragma once
+#include "../../Lab2/RunMealy/Transducer.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Independent words, the symbols of word w are symbols[offsets[w], offsets[w + 1])
+struct WordBatch
+{
+	std::vector<int32_t> symbols;
+	std::vector<size_t> offsets{ 0 };
+
+	size_t Count() const
+	{
+		return offsets.size() - 1;
+	}
+};
+
+// Row reached by a word and the output of its last transition, -1 for an empty word
+struct WordResult
+{
+	size_t row = 0;
+	int32_t output = -1;
+
+	friend bool operator==(const WordResult& left, const WordResult& right) = default;
+};
+
+// One word after another, every step waits for the load of the previous one
+template <typename T>
+void RunSerial(const PackedTransducer<T>& machine, size_t start, const WordBatch& words, std::span<WordResult> results)
+{
+	const TransducerEntry<T>* table = machine.Data();
+
+	for (size_t w = 0; w < words.Count(); w++)
+	{
+		WordResult result{ start, -1 };
+
+		for (size_t i = words.offsets[w]; i < words.offsets[w + 1]; i++)
+		{
+			TransducerEntry<T> entry = table[result.row + words.symbols[i]];
+			result.row = entry.next;
+			result.output = entry.output;
+		}
+
+		results[w] = result;
+	}
+}
+
+// Lanes words are advanced in lockstep. Their loads do not depend on each other,
+// so the core keeps several of them in flight. A lane that finishes takes the next word.
+template <typename T, size_t Lanes = 8>
+void RunInterleaved(const PackedTransducer<T>& machine, size_t start, const WordBatch& words, std::span<WordResult> results)
+{
+	const TransducerEntry<T>* table = machine.Data();
+	const int32_t* symbols = words.symbols.data();
+	size_t row[Lanes];
+	size_t pos[Lanes];
+	size_t end[Lanes];
+	size_t word[Lanes];
+	int32_t output[Lanes];
+	size_t next = 0;
+	size_t active = 0;
+
+	// Hands the lane the next non-empty word, empty ones are finished right away
+	auto assign = [&](size_t lane) {
+		while (next < words.Count() && words.offsets[next] == words.offsets[next + 1])
+		{
+			results[next++] = { start, -1 };
+		}
+
+		if (next == words.Count())
+		{
+			pos[lane] = end[lane] = 0;
+			return false;
+		}
+
+		word[lane] = next;
+		pos[lane] = words.offsets[next];
+		end[lane] = words.offsets[next + 1];
+		row[lane] = start;
+		next++;
+
+		return true;
+	};
+
+	for (size_t lane = 0; lane < Lanes; lane++)
+	{
+		active += assign(lane) ? 1 : 0;
+	}
+
+	while (active != 0)
+	{
+		for (size_t lane = 0; lane < Lanes; lane++)
+		{
+			if (pos[lane] == end[lane])
+			{
+				continue;
+			}
+
+			TransducerEntry<T> entry = table[row[lane] + symbols[pos[lane]]];
+			row[lane] = entry.next;
+			output[lane] = entry.output;
+
+			if (++pos[lane] == end[lane])
+			{
+				results[word[lane]] = { row[lane], output[lane] };
+				active -= assign(lane) ? 0 : 1;
+			}
+		}
+	}
+}
+
+#ifdef __AVX2__
+// Eight words advanced with AVX2 gathers: one gather fetches their next symbols and one
+// fetches the table cells, a 16-bit cell being one 32-bit element. Lanes without work
+// stand still on the sink row. Symbol positions must fit into int32_t.
+inline void RunGather(const PackedTransducer<uint16_t>& machine, size_t start, const WordBatch& words,
+	std::span<WordResult> results)
+{
+	const int* table = reinterpret_cast<const int*>(machine.Data());
+	const int* symbols = words.symbols.data();
+	alignas(32) int32_t row[8];
+	alignas(32) int32_t pos[8];
+	alignas(32) int32_t end[8];
+	alignas(32) int32_t step[8];
+	alignas(32) int32_t output[8];
+	size_t word[8];
+	size_t next = 0;
+	size_t active = 0;
+
+	auto assign = [&](int lane) {
+		while (next < words.Count() && words.offsets[next] == words.offsets[next + 1])
+		{
+			results[next++] = { start, -1 };
+		}
+
+		if (next == words.Count())
+		{
+			row[lane] = static_cast<int32_t>(machine.SinkRow());
+			pos[lane] = 0;
+			end[lane] = -1;
+			step[lane] = 0;
+			return false;
+		}
+
+		word[lane] = next;
+		row[lane] = static_cast<int32_t>(start);
+		pos[lane] = static_cast<int32_t>(words.offsets[next]);
+		end[lane] = static_cast<int32_t>(words.offsets[next + 1]);
+		step[lane] = 1;
+		next++;
+
+		return true;
+	};
+
+	for (int lane = 0; lane < 8; lane++)
+	{
+		active += assign(lane) ? 1 : 0;
+	}
+
+	const __m256i low = _mm256_set1_epi32(0xFFFF);
+	__m256i rows = _mm256_load_si256(reinterpret_cast<const __m256i*>(row));
+	__m256i positions = _mm256_load_si256(reinterpret_cast<const __m256i*>(pos));
+	__m256i ends = _mm256_load_si256(reinterpret_cast<const __m256i*>(end));
+	__m256i steps = _mm256_load_si256(reinterpret_cast<const __m256i*>(step));
+
+	while (active != 0)
+	{
+		// Idle lanes read the first symbol, which always exists while any lane is active
+		__m256i symbol = _mm256_i32gather_epi32(symbols, positions, 4);
+		__m256i cell = _mm256_i32gather_epi32(table, _mm256_add_epi32(rows, symbol), 4);
+
+		rows = _mm256_and_si256(cell, low);
+		positions = _mm256_add_epi32(positions, steps);
+
+		int finished = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(positions, ends)));
+
+		if (finished == 0)
+		{
+			continue;
+		}
+
+		_mm256_store_si256(reinterpret_cast<__m256i*>(row), rows);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(pos), positions);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(output), _mm256_srli_epi32(cell, 16));
+
+		for (int lane = 0; lane < 8; lane++)
+		{
+			if ((finished >> lane) & 1)
+			{
+				results[word[lane]] = { static_cast<size_t>(row[lane]), output[lane] };
+				active -= assign(lane) ? 0 : 1;
+			}
+		}
+
+		rows = _mm256_load_si256(reinterpret_cast<const __m256i*>(row));
+		positions = _mm256_load_si256(reinterpret_cast<const __m256i*>(pos));
+		ends = _mm256_load_si256(reinterpret_cast<const __m256i*>(end));
+		steps = _mm256_load_si256(reinterpret_cast<const __m256i*>(step));
+	}
+}
+#endif
@@ -0,0 +1,260 @@
+#include "../../Common/Stats.h"
+#include "Cases.h"
+#include "Inputs.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+// The MSVC runtime only has the underscored names, /sdl makes the POSIX ones an error
+#define popen _popen
+#define pclose _pclose
+#endif
+
+// Runs every tool on random machines of 10^2 up to 10^7 states over several alphabet sizes
+// and prints a CSV row for every stage: its time, cells per second and the peak memory.
+// Each case runs in a child process of its own, so peak memory belongs to that case only.
+struct Tool
+{
+	std::string name;
+	void (*writeInput)(const std::string& fileName, const GeneratorOptions& options);
+	Stages (*run)(const std::string& fileName, int threads);
+};
+
+const std::vector<Tool> Tools{
+	{ "mealy-to-moore", WriteInput<WriteMealy>, RunMealyToMoore },
+	{ "moore-to-mealy", WriteInput<WriteMoore>, RunMooreToMealy },
+	{ "minimize-mealy", WriteInput<WriteMealyTable>, RunMinimizeMealy },
+	{ "minimize-moore", WriteInput<WriteMooreTable>, RunMinimizeMoore },
+	{ "determinize", WriteInput<WritePairedNfa>, RunDeterminize },
+};
+
+struct Options
+{
+	long long maxStates = 10'000'000;
+	long long maxCells = 100'000'000;
+	// The determinizer keeps a bit set of all NFA states per DFA state, memory grows quadratically
+	long long maxNfaStates = 10'000;
+	std::vector<int> inputs{ 2, 8, 32 };
+	std::vector<std::string> tools;
+	int threads = 1;
+	uint64_t seed = 1;
+};
+
+const Tool& FindTool(const std::string& name);
+std::vector<std::string> SplitList(const std::string& list);
+int RunCase(const Tool& tool, const std::string& fileName, int threads);
+void RunSweep(const std::string& self, const Options& options);
+
+int main(int argc, char* argv[])
+try
+{
+	if (argc == 5 && std::string(argv[1]) == "--case")
+	{
+		return RunCase(FindTool(argv[2]), argv[3], std::stoi(argv[4]));
+	}
+
+	Options options;
+
+	for (int i = 1; i < argc; i += 2)
+	{
+		std::string option = argv[i];
+
+		if (i + 1 == argc)
+		{
+			argc = 0;
+			break;
+		}
+
+		if (option == "--max-states")
+		{
+			options.maxStates = std::stoll(argv[i + 1]);
+		}
+		else if (option == "--max-cells")
+		{
+			options.maxCells = std::stoll(argv[i + 1]);
+		}
+		else if (option == "--max-nfa-states")
+		{
+			options.maxNfaStates = std::stoll(argv[i + 1]);
+		}
+		else if (option == "--inputs")
+		{
+			options.inputs.clear();
+
+			for (const std::string& count : SplitList(argv[i + 1]))
+			{
+				options.inputs.push_back(std::stoi(count));
+			}
+		}
+		else if (option == "--tools")
+		{
+			options.tools = SplitList(argv[i + 1]);
+
+			for (const std::string& name : options.tools)
+			{
+				FindTool(name);
+			}
+		}
+		else if (option == "--threads")
+		{
+			options.threads = std::max(std::stoi(argv[i + 1]), 1);
+		}
+		else if (option == "--seed")
+		{
+			options.seed = std::stoull(argv[i + 1]);
+		}
+		else
+		{
+			argc = 0;
+			break;
+		}
+	}
+
+	if (argc == 0)
+	{
+		std::cerr << "Expected arguments: [--max-states N] [--max-cells N] [--max-nfa-states N] [--inputs A,B,...] "
+					 "[--tools T,...] [--threads N] [--seed S]" << std::endl
+				  << "Tools: mealy-to-moore, moore-to-mealy, minimize-mealy, minimize-moore, determinize" << std::endl;
+		return 1;
+	}
+
+	RunSweep(argv[0], options);
+}
+catch (const std::exception& e)
+{
+	std::cerr << e.what() << std::endl;
+	return 1;
+}
+
+const Tool& FindTool(const std::string& name)
+{
+	for (const Tool& tool : Tools)
+	{
+		if (tool.name == name)
+		{
+			return tool;
+		}
+	}
+
+	throw std::runtime_error("Unknown tool " + name);
+}
+
+std::vector<std::string> SplitList(const std::string& list)
+{
+	std::vector<std::string> items;
+	std::istringstream stream(list);
+
+	for (std::string item; std::getline(stream, item, ',');)
+	{
+		items.push_back(item);
+	}
+
+	return items;
+}
+
+// Child side: "<stage> <seconds>" per line, then "peak <kilobytes>"
+int RunCase(const Tool& tool, const std::string& fileName, int threads)
+{
+	for (const Stage& stage : tool.run(fileName, threads))
+	{
+		std::cout << stage.name << ' ' << stage.seconds << '\n';
+	}
+
+	std::cout << "peak " << PeakMemoryKb() << std::endl;
+
+	return 0;
+}
+
+void RunSweep(const std::string& self, const Options& options)
+{
+	std::filesystem::path directory = std::filesystem::temp_directory_path();
+
+	std::cout << "tool,states,inputs,stage,seconds,cells_per_second,peak_rss_kb" << std::endl;
+
+	for (const Tool& tool : Tools)
+	{
+		if (!options.tools.empty() && std::find(options.tools.begin(), options.tools.end(), tool.name) == options.tools.end())
+		{
+			continue;
+		}
+
+		long long maxStates = tool.name == "determinize" ? std::min(options.maxStates, options.maxNfaStates) : options.maxStates;
+
+		for (long long states = 100; states <= maxStates; states *= 10)
+		{
+			for (int inputs : options.inputs)
+			{
+				long long cells = states * inputs;
+
+				if (cells > options.maxCells)
+				{
+					continue;
+				}
+
+				std::string fileName = (directory / ("benchmark-" + tool.name + "-" + std::to_string(states)
+					+ "-" + std::to_string(inputs) + ".txt")).string();
+				tool.writeInput(fileName, InputOptions(static_cast<int>(states), inputs, options.seed));
+
+				std::string command = "\"" + self + "\" --case " + tool.name + " \"" + fileName + "\" "
+					+ std::to_string(options.threads);
+#ifdef _WIN32
+				// cmd.exe drops the outer quotes of a command that starts with one
+				command = "\"" + command + "\"";
+#endif
+				std::unique_ptr<FILE, int (*)(FILE*)> child(popen(command.c_str(), "r"), pclose);
+
+				if (!child)
+				{
+					std::filesystem::remove(fileName);
+					throw std::runtime_error("Unable to run " + command);
+				}
+
+				std::string report;
+				char buffer[256];
+
+				while (fgets(buffer, sizeof(buffer), child.get()) != nullptr)
+				{
+					report += buffer;
+				}
+
+				int status = pclose(child.release());
+				std::filesystem::remove(fileName);
+
+				Stages stages;
+				long long peak = -1;
+				std::istringstream lines(report);
+
+				for (Stage stage; lines >> stage.name >> stage.seconds;)
+				{
+					if (stage.name == "peak")
+					{
+						peak = static_cast<long long>(stage.seconds);
+					}
+					else
+					{
+						stages.push_back(stage);
+					}
+				}
+
+				if (status != 0 || peak == -1)
+				{
+					std::cerr << tool.name << " failed on " << states << " states and " << inputs << " inputs" << std::endl;
+					continue;
+				}
+
+				for (const Stage& stage : stages)
+				{
+					std::cout << tool.name << ',' << states << ',' << inputs << ',' << stage.name << ','
+							  << stage.seconds << ',' << static_cast<long long>(cells / std::max(stage.seconds, 1e-9))
+							  << ',' << peak << std::endl;
+				}
+			}
+		}
+	}
+}
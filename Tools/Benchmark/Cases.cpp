@@ -0,0 +1,104 @@
+#include "Cases.h"
+#include "../../Common/MappedFile.h"
+#include "../../Lab1/Lab1/core.h"
+#include "../../Lab1/MooreToMealy/core.h"
+#include "../../Lab2/MinimizeMealy/core.h"
+#include "../../Lab2/MinimizeMoore/core.h"
+#include "../../Lab3/Lab3/Nfa.h"
+#include <memory>
+#include <tuple>
+#include <utility>
+
+Stages RunMealyToMoore(const std::string& fileName, int threads)
+{
+	using namespace MealyToMoore;
+
+	Stages stages;
+	MachineMatrix matrix;
+	TransitionSet transitions;
+	NullStream output;
+
+	Measure(stages, "parse", [&] { matrix = ReadFile(fileName); });
+	Measure(stages, "core", [&] { transitions = AddMooreStates(matrix, threads); });
+	Measure(stages, "write", [&] { WriteMooreMachineToStream(matrix, transitions, output, threads); });
+
+	return stages;
+}
+
+// The tool has no separate core stage, "stream" is the conversion without the matrix
+Stages RunMooreToMealy(const std::string& fileName, int)
+{
+	using namespace MooreToMealy;
+
+	Stages stages;
+	MachineMatrix matrix;
+	NullStream output;
+
+	Measure(stages, "parse", [&] { matrix = ReadFile(fileName); });
+	Measure(stages, "write", [&] { WriteMealyMachineToStream(matrix, output); });
+	Measure(stages, "stream", [&] { ConvertToMealyStream(fileName, output); });
+
+	return stages;
+}
+
+Stages RunMinimizeMealy(const std::string& fileName, int threads)
+{
+	using namespace MinimizeMealy;
+
+	Stages stages;
+	MachineMatrix matrix;
+	MachineMatrix minimized;
+	NullStream output;
+
+	Measure(stages, "parse", [&] { matrix = LoadMatrix(std::make_shared<MappedFile>(fileName), threads); });
+	Measure(stages, "core", [&] { minimized = Minimize(matrix, matrix.rows, matrix.cols, threads); });
+	Measure(stages, "write", [&] {
+		WriteMachineMatrixToStream(minimized, minimized.rows, minimized.cols, output, threads);
+	});
+
+	return stages;
+}
+
+Stages RunMinimizeMoore(const std::string& fileName, int threads)
+{
+	using namespace MinimizeMoore;
+
+	Stages stages;
+	MachineMatrix matrix;
+	MachineMatrix minimized;
+	NullStream output;
+
+	Measure(stages, "parse", [&] { matrix = LoadMatrix(std::make_shared<MappedFile>(fileName), threads); });
+	Measure(stages, "core", [&] { minimized = Minimize(matrix, matrix.rows, matrix.cols, threads); });
+	Measure(stages, "write", [&] {
+		WriteMachineMatrixToStream(minimized, minimized.rows, minimized.cols, output, threads);
+	});
+
+	return stages;
+}
+
+Stages RunDeterminize(const std::string& fileName, int threads)
+{
+	using namespace Determinizer;
+
+	Stages stages;
+	Table table;
+	int symbols = 0;
+	int states = 0;
+	std::vector<int32_t> dfa;
+	NullStream output;
+
+	Measure(stages, "parse", [&] {
+		auto [countState, countSymbol, nfa] = ReadNfa(fileName);
+		symbols = countSymbol;
+		table = std::move(nfa);
+	});
+	Measure(stages, "core", [&] {
+		NfaView nfa(table, symbols);
+		EClosures closures = CreateEClosures(nfa);
+		std::tie(states, dfa) = Determinize(nfa, symbols, closures, threads);
+	});
+	Measure(stages, "write", [&] { WriteDfaToStream(states, symbols, dfa, output); });
+
+	return stages;
+}
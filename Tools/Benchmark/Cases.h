@@ -0,0 +1,57 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+// Time of one stage of a tool: parsing, the core algorithm or writing the result
+struct Stage
+{
+	std::string name;
+	double seconds = 0;
+};
+
+using Stages = std::vector<Stage>;
+
+// Every case runs one tool on an input file in its text format, the result goes nowhere.
+// The cases call the tools' own core functions, each tool keeps them in a namespace of its own.
+Stages RunMealyToMoore(const std::string& fileName, int threads);
+Stages RunMooreToMealy(const std::string& fileName, int threads);
+Stages RunMinimizeMealy(const std::string& fileName, int threads);
+Stages RunMinimizeMoore(const std::string& fileName, int threads);
+Stages RunDeterminize(const std::string& fileName, int threads);
+
+// Output stream that drops everything, writing still formats the whole result
+class NullStream : public std::ostream
+{
+public:
+	NullStream()
+		: std::ostream(&m_buffer)
+	{
+	}
+
+private:
+	struct NullBuffer : std::streambuf
+	{
+		int overflow(int c) override
+		{
+			return c;
+		}
+
+		std::streamsize xsputn(const char*, std::streamsize count) override
+		{
+			return count;
+		}
+	};
+
+	NullBuffer m_buffer;
+};
+
+inline void Measure(Stages& stages, const std::string& name, const std::function<void()>& run)
+{
+	auto start = std::chrono::steady_clock::now();
+	run();
+	stages.push_back({ name, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() });
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "../../Common/OutputBuffer.h"
+#include "../../Common/Random.h"
+#include "../Generate/Generator.h"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Random machines for the benchmark in the text format of each tool,
+// with uniform targets and one missing cell in MissingRate
+constexpr int MissingRate = 16;
+
+inline GeneratorOptions InputOptions(int states, int inputs, uint64_t seed)
+{
+	GeneratorOptions options;
+	options.states = states;
+	options.inputs = inputs;
+	options.outputs = 4;
+	options.missing = 1.0 / MissingRate;
+	options.seed = seed;
+
+	return options;
+}
+
+template <void (*Write)(std::ostream&, const GeneratorOptions&)>
+void WriteInput(const std::string& fileName, const GeneratorOptions& options)
+{
+	std::ofstream file(fileName, std::ios::binary);
+
+	if (!file.is_open())
+	{
+		throw std::runtime_error("Unable to create file " + fileName);
+	}
+
+	Write(file, options);
+}
+
+// Lab3 NFA with a DFA of known size, the DFAs of WriteNfa grow exponentially with random targets.
+// States 2p and 2p + 1 form a pair, both go into the same random pair on a symbol and an epsilon
+// move stays within the pair. Every reachable subset is then a part of one pair, so the DFA has
+// at most 1.5 states per NFA state while cells still have several targets and closures are not trivial.
+inline void WritePairedNfa(std::ostream& stream, const GeneratorOptions& shape)
+{
+	OutputBuffer out(stream);
+	Random random(shape.seed);
+	int pairs = (shape.states + 1) / 2;
+
+	// Targets of a cell within the pair: the first, the second or both states
+	auto writeTargets = [&](int pair, int kind) {
+		int first = 2 * pair;
+		bool second = first + 1 < shape.states;
+
+		if (kind == 0 || !second)
+		{
+			out << first;
+		}
+		else if (kind == 1)
+		{
+			out << first + 1;
+		}
+		else
+		{
+			out << first << ',' << first + 1;
+		}
+	};
+
+	std::vector<int> pairTargets(static_cast<size_t>(shape.inputs));
+
+	out << shape.states << ' ' << shape.inputs << '\n';
+
+	for (int p = 0; p < pairs; p++)
+	{
+		for (int& target : pairTargets)
+		{
+			target = random.Below(MissingRate) == 0 ? -1 : random.Below(pairs);
+		}
+
+		for (int s = 2 * p; s < std::min(2 * p + 2, shape.states); s++)
+		{
+			for (int target : pairTargets)
+			{
+				if (target == -1)
+				{
+					out << "- ";
+					continue;
+				}
+
+				writeTargets(target, random.Below(3));
+				out << ' ';
+			}
+
+			// Only the first state of a pair has an epsilon move, to its partner
+			bool epsilon = s % 2 == 0 && s + 1 < shape.states && random.Below(4) == 0;
+			out << (epsilon ? std::to_string(s + 1) : "-") << '\n';
+		}
+	}
+}
@@ -0,0 +1,52 @@
+#include "../../Common/Automaton.h"
+#include "../../Common/BinaryMachine.h"
+#include "../../Common/MachineText.h"
+#include "../../Common/MappedFile.h"
+#include "../../Common/OutputBuffer.h"
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+int main(int argc, char* argv[])
+try
+{
+	const std::map<std::string, TextFormat>& formats = TextFormatNames();
+
+	if (argc != 4 || !formats.contains(argv[1]))
+	{
+		std::cerr << "Expected arguments: <mealy|moore|mealy-table|moore-table|nfa|dfa> <input file> <output file>" << std::endl
+				  << "A text input is converted to the binary format, a binary one to the given text format" << std::endl;
+		return 1;
+	}
+
+	TextFormat format = formats.at(argv[1]);
+	auto file = std::make_shared<MappedFile>(argv[2]);
+	Automaton machine = ReadAutomaton(file, format);
+
+	if (IsBinaryMachine(file->Data()))
+	{
+		std::ofstream output(argv[3], std::ios::binary);
+
+		if (!output.is_open())
+		{
+			throw std::runtime_error("Unable to create file " + std::string(argv[3]));
+		}
+
+		{
+			OutputBuffer out(output);
+			WriteText(format, machine, out);
+		}
+
+		CheckOutput(output);
+	}
+	else
+	{
+		WriteBinaryMachine(argv[3], machine);
+	}
+}
+catch (const std::exception& e)
+{
+	std::cerr << e.what() << std::endl;
+	return 1;
+}
@@ -0,0 +1,103 @@
+#include "../../Common/OutputBuffer.h"
+#include "Generator.h"
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Writes a random machine in the text format of one of the tools. The same arguments
+// always give the same file, rows are written as they are generated.
+int main(int argc, char* argv[])
+try
+{
+	GeneratorOptions options;
+	std::string outputName;
+
+	for (int i = 4; i < argc; i += 2)
+	{
+		std::string option = argv[i];
+
+		if (i + 1 == argc)
+		{
+			argc = 0;
+			break;
+		}
+
+		if (option == "--outputs")
+		{
+			options.outputs = std::stoi(argv[i + 1]);
+		}
+		else if (option == "--classes")
+		{
+			options.classes = std::stoi(argv[i + 1]);
+		}
+		else if (option == "--missing")
+		{
+			options.missing = std::stod(argv[i + 1]);
+		}
+		else if (option == "--epsilon")
+		{
+			options.epsilon = std::stod(argv[i + 1]);
+		}
+		else if (option == "--targets")
+		{
+			options.targets = std::stoi(argv[i + 1]);
+		}
+		else if (option == "--seed")
+		{
+			options.seed = std::stoull(argv[i + 1]);
+		}
+		else if (option == "--output")
+		{
+			outputName = argv[i + 1];
+		}
+		else
+		{
+			argc = 0;
+			break;
+		}
+	}
+
+	std::string format = argc >= 4 ? argv[1] : "";
+	auto write = format == "mealy" ? WriteMealy
+		: format == "moore" ? WriteMoore
+		: format == "mealy-table" ? WriteMealyTable
+		: format == "moore-table" ? WriteMooreTable
+		: format == "nfa" ? WriteNfa
+		: nullptr;
+
+	if (write == nullptr)
+	{
+		std::cerr << "Expected arguments: <mealy|moore|mealy-table|moore-table|nfa> <states> <inputs> "
+					 "[--outputs N] [--classes N] [--missing P] [--epsilon E] [--targets N] [--seed S] [--output <file>]"
+				  << std::endl
+				  << "mealy and moore are the Lab1 inputs, the tables are the Lab2 inputs, nfa is the Lab3 input" << std::endl
+				  << "--classes plants that many equivalence classes, the minimized machine has exactly that many states"
+				  << std::endl;
+		return 1;
+	}
+
+	options.states = std::stoi(argv[2]);
+	options.inputs = std::stoi(argv[3]);
+
+	std::ofstream outputFile;
+
+	if (!outputName.empty())
+	{
+		outputFile.open(outputName, std::ios::binary);
+
+		if (!outputFile.is_open())
+		{
+			throw std::runtime_error("Unable to create file " + outputName);
+		}
+	}
+
+	std::ostream& output = outputFile.is_open() ? static_cast<std::ostream&>(outputFile) : std::cout;
+
+	write(output, options);
+	CheckOutput(output);
+}
+catch (const std::exception& e)
+{
+	std::cerr << e.what() << std::endl;
+	return 1;
+}
@@ -0,0 +1,259 @@
+#pragma once
+#include "../../Common/OutputBuffer.h"
+#include "../../Common/Random.h"
+#include <cmath>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Shape of a random machine. Each state belongs to one of the planted classes, state s to
+// class s % classes, and all states of a class have the same outputs and missing cells and go
+// into the same classes. Symbol 0 links the classes into a cycle on which only class 0 gives
+// output 0, so the classes are pairwise distinguishable and the minimal machine has exactly
+// classes states. Symbol 0 is therefore never missing.
+struct GeneratorOptions
+{
+	int states = 0;
+	int inputs = 0;
+	int outputs = 2;
+	// 0 makes every state a class of its own, so the machine is already minimal
+	int classes = 0;
+	// Probability that a cell is "-"
+	double missing = 0;
+	// NFA only: mean number of epsilon edges per state and largest number of targets per cell
+	double epsilon = 0;
+	int targets = 2;
+	uint64_t seed = 1;
+};
+
+// One row of a Mealy or Moore machine, -1 marks a missing transition
+struct GeneratedRow
+{
+	int output = 0;
+	std::vector<int> targets;
+	std::vector<int> outputs;
+};
+
+// Rows are generated one at a time, memory does not depend on the number of states
+class MachineGenerator
+{
+public:
+	explicit MachineGenerator(const GeneratorOptions& options)
+		: m_options(options)
+		, m_classes(options.classes == 0 ? options.states : options.classes)
+		, m_random(options.seed)
+	{
+		if (options.states <= 0 || options.inputs <= 0)
+		{
+			throw std::runtime_error("A machine needs at least one state and one input");
+		}
+
+		if (m_classes > options.states)
+		{
+			throw std::runtime_error("There cannot be more classes than states");
+		}
+
+		if (m_classes > 1 && options.outputs < 2)
+		{
+			throw std::runtime_error("Distinct classes need at least two outputs");
+		}
+	}
+
+	// Rows must be requested in order
+	void NextRow(int state, GeneratedRow& row)
+	{
+		int inputs = m_options.inputs;
+		int outputs = m_options.outputs;
+		int c = state % m_classes;
+
+		// The class row is the same for every member, only the target members are random
+		Random classRandom = Random::ForKey(m_options.seed, static_cast<uint64_t>(c));
+
+		row.targets.resize(inputs);
+		row.outputs.resize(inputs);
+		row.output = c == 0 || outputs < 2 ? 0 : 1 + classRandom.Below(outputs - 1);
+
+		for (int a = 0; a < inputs; a++)
+		{
+			bool missing = classRandom.Chance(m_options.missing) && a != 0;
+			int target = a == 0 ? (c + 1) % m_classes : classRandom.Below(m_classes);
+			int output = a != 0 ? classRandom.Below(outputs) : row.output;
+
+			row.targets[a] = missing ? -1 : Member(target);
+			row.outputs[a] = missing ? -1 : output;
+		}
+	}
+
+private:
+	int Member(int c)
+	{
+		int members = (m_options.states - 1 - c) / m_classes + 1;
+		return c + m_classes * m_random.Below(members);
+	}
+
+	GeneratorOptions m_options;
+	int m_classes;
+	Random m_random;
+};
+
+// Lab1 Mealy machine: "S2 Y1, -, S0 Y3"
+inline void WriteMealy(std::ostream& stream, const GeneratorOptions& options)
+{
+	MachineGenerator generator(options);
+	GeneratedRow row;
+	OutputBuffer out(stream);
+
+	out << options.states << ' ' << options.inputs << '\n';
+
+	for (int i = 0; i < options.states; i++)
+	{
+		generator.NextRow(i, row);
+
+		for (int j = 0; j < options.inputs; j++)
+		{
+			out << (j == 0 ? "" : ", ");
+
+			if (row.targets[j] == -1)
+			{
+				out << '-';
+				continue;
+			}
+
+			out << 'S' << row.targets[j] << " Y" << row.outputs[j];
+		}
+
+		out << '\n';
+	}
+}
+
+// MooreToMealy Moore machine: "Y1 q2 - q0"
+inline void WriteMoore(std::ostream& stream, const GeneratorOptions& options)
+{
+	MachineGenerator generator(options);
+	GeneratedRow row;
+	OutputBuffer out(stream);
+
+	out << options.states << ' ' << options.inputs << '\n';
+
+	for (int i = 0; i < options.states; i++)
+	{
+		generator.NextRow(i, row);
+		out << 'Y' << row.output;
+
+		for (int target : row.targets)
+		{
+			if (target == -1)
+			{
+				out << " -";
+				continue;
+			}
+
+			out << " q" << target;
+		}
+
+		out << '\n';
+	}
+}
+
+// MinimizeMealy table: "2 1 - 0 3"
+inline void WriteMealyTable(std::ostream& stream, const GeneratorOptions& options)
+{
+	MachineGenerator generator(options);
+	GeneratedRow row;
+	OutputBuffer out(stream);
+
+	out << options.states << ' ' << options.inputs << '\n';
+
+	for (int i = 0; i < options.states; i++)
+	{
+		generator.NextRow(i, row);
+
+		for (int j = 0; j < options.inputs; j++)
+		{
+			out << (j == 0 ? "" : " ");
+
+			if (row.targets[j] == -1)
+			{
+				out << '-';
+				continue;
+			}
+
+			out << row.targets[j] << ' ' << row.outputs[j];
+		}
+
+		out << '\n';
+	}
+}
+
+// MinimizeMoore table: "1 2 - 0"
+inline void WriteMooreTable(std::ostream& stream, const GeneratorOptions& options)
+{
+	MachineGenerator generator(options);
+	GeneratedRow row;
+	OutputBuffer out(stream);
+
+	out << options.states << ' ' << options.inputs << '\n';
+
+	for (int i = 0; i < options.states; i++)
+	{
+		generator.NextRow(i, row);
+		out << row.output;
+
+		for (int target : row.targets)
+		{
+			if (target == -1)
+			{
+				out << " -";
+				continue;
+			}
+
+			out << ' ' << target;
+		}
+
+		out << '\n';
+	}
+}
+
+// Lab3 NFA: "0,1 - 3" with the epsilon column last. A present cell has 1 to targets random
+// targets, a state has floor(epsilon) epsilon edges and one more with the fractional part
+// as probability. Classes do not apply, the NFA has no outputs.
+inline void WriteNfa(std::ostream& stream, const GeneratorOptions& options)
+{
+	if (options.states <= 0 || options.inputs <= 0 || options.targets <= 0)
+	{
+		throw std::runtime_error("An NFA needs at least one state, one input and one target per cell");
+	}
+
+	Random random(options.seed);
+	OutputBuffer out(stream);
+	double wholeEdges = std::floor(options.epsilon);
+	double extraEdge = options.epsilon - wholeEdges;
+
+	auto writeTargets = [&](int count) {
+		if (count == 0)
+		{
+			out << '-';
+			return;
+		}
+
+		for (int t = 0; t < count; t++)
+		{
+			out << (t == 0 ? "" : ",") << random.Below(options.states);
+		}
+	};
+
+	out << options.states << ' ' << options.inputs << '\n';
+
+	for (int i = 0; i < options.states; i++)
+	{
+		for (int j = 0; j < options.inputs; j++)
+		{
+			writeTargets(random.Chance(options.missing) ? 0 : 1 + random.Below(options.targets));
+			out << ' ';
+		}
+
+		writeTargets(static_cast<int>(wholeEdges) + (random.Chance(extraEdge) ? 1 : 0));
+		out << '\n';
+	}
+}
@@ -0,0 +1,215 @@
+#include "../../Common/AllocationHooks.h"
+#include "../../Common/Automaton.h"
+#include "../../Common/MachineText.h"
+#include "../../Common/MappedFile.h"
+#include "../../Common/OutputBuffer.h"
+#include "../../Common/Stats.h"
+#include "Stages.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using StageFunction = Automaton (*)(Automaton, int);
+
+struct PipelineStage
+{
+	std::string_view name;
+	// Timer of the whole stage, the tools time their own phases inside it
+	std::string_view timer;
+	StageFunction run;
+};
+
+Automaton MinimizeStage(Automaton machine, int threads);
+std::vector<PipelineStage> ParseStages(std::string_view text);
+TextFormat DefaultFormat(MachineKind kind);
+
+// Runs the stages of a pipeline such as "determinize | minimize | to-moore" on one machine in memory.
+// Only the input is read and only the last result is written.
+int main(int argc, char* argv[])
+try
+{
+	const std::map<std::string, TextFormat>& formats = TextFormatNames();
+	std::string outputFormat;
+	std::string outputName;
+	std::string binaryOutput;
+	int threads = 1;
+
+	for (int i = 4; i < argc; i += 2)
+	{
+		std::string option = argv[i];
+
+		if (option == "--stats")
+		{
+			Stats::Enable();
+			i--;
+			continue;
+		}
+
+		if (i + 1 == argc)
+		{
+			argc = 0;
+			break;
+		}
+
+		if (option == "--threads")
+		{
+			threads = std::stoi(argv[i + 1]);
+			threads = threads > 0 ? threads : static_cast<int>(std::thread::hardware_concurrency());
+		}
+		else if (option == "--format" && formats.contains(argv[i + 1]))
+		{
+			outputFormat = argv[i + 1];
+		}
+		else if (option == "--output")
+		{
+			outputName = argv[i + 1];
+		}
+		else if (option == "--binary")
+		{
+			binaryOutput = argv[i + 1];
+		}
+		else
+		{
+			argc = 0;
+			break;
+		}
+	}
+
+	if (argc < 4 || !formats.contains(argv[1]))
+	{
+		std::cerr << "Expected arguments: <mealy|moore|mealy-table|moore-table|nfa|dfa> <input file> \"<stage> | <stage> ...\" "
+					 "[--format <output format>] [--output <file>] [--binary <file>] [--threads N] [--stats]"
+				  << std::endl
+				  << "Stages: determinize, minimize, to-moore, to-mealy. The result is written in the format of the input "
+					 "tools, mealy, moore or dfa, unless --format says otherwise"
+				  << std::endl;
+		return 1;
+	}
+
+	std::vector<PipelineStage> stages = ParseStages(argv[3]);
+	Automaton machine;
+
+	{
+		ScopedTimer timer("parse");
+		machine = ReadAutomaton(std::make_shared<MappedFile>(argv[2]), formats.at(argv[1]));
+	}
+
+	for (const PipelineStage& stage : stages)
+	{
+		ScopedTimer timer(stage.timer);
+		machine = stage.run(std::move(machine), threads);
+	}
+
+	{
+		ScopedTimer timer("write");
+
+		if (!binaryOutput.empty())
+		{
+			WriteBinaryMachine(binaryOutput, machine);
+		}
+		else
+		{
+			TextFormat format = outputFormat.empty() ? DefaultFormat(machine.kind) : formats.at(outputFormat);
+			std::ofstream outputFile;
+
+			if (!outputName.empty())
+			{
+				outputFile.open(outputName, std::ios::binary);
+
+				if (!outputFile.is_open())
+				{
+					throw std::runtime_error("Unable to create file " + outputName);
+				}
+			}
+
+			std::ostream& output = outputFile.is_open() ? static_cast<std::ostream&>(outputFile) : std::cout;
+
+			{
+				OutputBuffer out(output);
+				WriteText(format, machine, out);
+			}
+
+			CheckOutput(output);
+		}
+	}
+
+	if (Stats::Enabled())
+	{
+		Stats::Count("states", static_cast<int64_t>(machine.states));
+		Stats::Write(std::cerr);
+	}
+}
+catch (const std::exception& e)
+{
+	std::cerr << e.what() << std::endl;
+	return 1;
+}
+
+Automaton MinimizeStage(Automaton machine, int threads)
+{
+	if (machine.kind == MachineKind::Moore)
+	{
+		return MinimizeMooreStage(std::move(machine), threads);
+	}
+
+	return MinimizeMealyStage(std::move(machine), threads);
+}
+
+// Stage names separated by "|", spaces around them are ignored
+std::vector<PipelineStage> ParseStages(std::string_view text)
+{
+	const PipelineStage known[] = {
+		{ "determinize", "stage_determinize", DeterminizeStage },
+		{ "minimize", "stage_minimize", MinimizeStage },
+		{ "to-moore", "stage_to_moore", ToMooreStage },
+		{ "to-mealy", "stage_to_mealy", ToMealyStage },
+	};
+
+	std::vector<PipelineStage> stages;
+
+	while (true)
+	{
+		size_t end = std::min(text.find('|'), text.size());
+		std::string_view name = text.substr(0, end);
+
+		name.remove_prefix(std::min(name.find_first_not_of(' '), name.size()));
+		name.remove_suffix(name.size() - std::min(name.find_last_not_of(' ') + 1, name.size()));
+
+		auto stage = std::ranges::find(known, name, &PipelineStage::name);
+
+		if (stage == std::end(known))
+		{
+			throw std::runtime_error("Unknown stage \"" + std::string(name) + "\"");
+		}
+
+		stages.push_back(*stage);
+
+		if (end == text.size())
+		{
+			return stages;
+		}
+
+		text.remove_prefix(end + 1);
+	}
+}
+
+TextFormat DefaultFormat(MachineKind kind)
+{
+	switch (kind)
+	{
+	case MachineKind::Mealy:
+		return TextFormat::Mealy;
+	case MachineKind::Moore:
+		return TextFormat::Moore;
+	case MachineKind::Nfa:
+		return TextFormat::Nfa;
+	default:
+		return TextFormat::Dfa;
+	}
+}
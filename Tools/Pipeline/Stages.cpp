@@ -0,0 +1,62 @@
+#include "Stages.h"
+#include "../../Lab1/Lab1/core.h"
+#include "../../Lab1/MooreToMealy/core.h"
+#include "../../Lab2/MinimizeMealy/core.h"
+#include "../../Lab2/MinimizeMoore/core.h"
+#include "../../Lab3/Lab3/Nfa.h"
+#include <utility>
+
+Automaton DeterminizeStage(Automaton nfa, int threads)
+{
+	ExpectKind(nfa, MachineKind::Nfa, "determinize");
+
+	return Determinizer::Determinize(nfa, threads);
+}
+
+Automaton MinimizeMealyStage(Automaton mealy, int threads)
+{
+	MachineKind kind = mealy.kind;
+
+	if (kind == MachineKind::Dfa)
+	{
+		mealy.outputs = MachineArray<int32_t>(mealy.states * mealy.inputs, 0);
+	}
+	else
+	{
+		ExpectKind(mealy, MachineKind::Mealy, "minimize");
+	}
+
+	Automaton result = MinimizeMealy::Minimize(std::move(mealy), threads);
+
+	if (kind == MachineKind::Dfa)
+	{
+		result.kind = MachineKind::Dfa;
+		result.outputs = MachineArray<int32_t>();
+	}
+
+	return result;
+}
+
+Automaton MinimizeMooreStage(Automaton moore, int threads)
+{
+	ExpectKind(moore, MachineKind::Moore, "minimize");
+
+	return MinimizeMoore::Minimize(std::move(moore), threads);
+}
+
+Automaton ToMooreStage(Automaton mealy, int threads)
+{
+	if (mealy.kind != MachineKind::Dfa)
+	{
+		ExpectKind(mealy, MachineKind::Mealy, "to-moore");
+	}
+
+	return MealyToMoore::ConvertToMoore(std::move(mealy), threads);
+}
+
+Automaton ToMealyStage(Automaton moore, int threads)
+{
+	ExpectKind(moore, MachineKind::Moore, "to-mealy");
+
+	return MooreToMealy::ConvertToMealy(std::move(moore), threads);
+}
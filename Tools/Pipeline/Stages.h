@@ -0,0 +1,25 @@
+#pragma once
+#include "../../Common/Automaton.h"
+#include "../../Common/BinaryMachine.h"
+#include <stdexcept>
+#include <string>
+
+// Every stage takes the machine of the previous one by value and returns the next one.
+// Arrays are moved from stage to stage and never written out in between, the stages call
+// the in-memory entry points of the tools.
+// DFAs have no final states, minimize and to-moore take them as Mealy machines with output 0
+// on every transition.
+Automaton DeterminizeStage(Automaton nfa, int threads);
+Automaton MinimizeMealyStage(Automaton mealy, int threads);
+Automaton MinimizeMooreStage(Automaton moore, int threads);
+Automaton ToMooreStage(Automaton mealy, int threads);
+Automaton ToMealyStage(Automaton moore, int threads);
+
+inline void ExpectKind(const Automaton& automaton, MachineKind kind, const std::string& stage)
+{
+	if (automaton.kind != kind)
+	{
+		throw std::runtime_error(stage + ": expected " + BinaryMachine::KindName(kind) + ", got "
+			+ BinaryMachine::KindName(automaton.kind));
+	}
+}